@@ -0,0 +1,280 @@
+#include "bench.hpp"
+#include "bench_baseline.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+namespace {
+// Зарегистрированный бенчмарк
+struct Registration {
+    std::string name;
+    BenchmarkFunction function;
+};
+
+// Реестр создается при первом обращении, чтобы не зависеть от порядка инициализации
+std::vector<Registration>& registry() {
+    static std::vector<Registration> benchmarks;
+    return benchmarks;
+}
+
+// Подбор числа итераций: удваиваем (или оцениваем по прошлому замеру), пока замер не станет достаточно длинным.
+// Остальные повторы идут с тем же числом итераций, чтобы их можно было сравнивать.
+// Аппаратные счетчики, если заданы, считаются только в повторах, но не при подборе.
+Result runBenchmark(const Registration& benchmark, double minSeconds, std::size_t repetitions, PerfCounters* counters) {
+    std::size_t iterations = 1;
+    double seconds = 0.0;
+    while (true) {
+        State state(iterations);
+        benchmark.function(state);
+        seconds = std::chrono::duration<double>(state.elapsed()).count();
+        if (seconds >= minSeconds || iterations >= 1000000000) {
+            break;
+        }
+
+        // Оценка нужного числа итераций с запасом, но не больше чем в 100 раз за шаг
+        double multiplier = seconds > 0 ? minSeconds * 1.4 / seconds : 100.0;
+        multiplier = std::clamp(multiplier, 2.0, 100.0);
+        iterations = static_cast<std::size_t>(static_cast<double>(iterations) * multiplier);
+    }
+
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    double items = 0.0;
+    double bytes = 0.0;
+    double totalSeconds = 0.0;
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+        State state(iterations, counters);
+        benchmark.function(state);
+        seconds = std::chrono::duration<double>(state.elapsed()).count();
+        result.samples.push_back(seconds * 1e9 / static_cast<double>(iterations));
+        items += static_cast<double>(state.itemsProcessed());
+        bytes += static_cast<double>(state.bytesProcessed());
+        totalSeconds += seconds;
+    }
+    result.itemsTotal = items;
+    result.iterationsTotal = static_cast<double>(iterations) * static_cast<double>(repetitions);
+    if (counters != nullptr) {
+        result.counters = counters->take();
+    }
+    result.itemsPerSecond = totalSeconds > 0 ? items / totalSeconds : 0.0;
+    result.bytesPerSecond = totalSeconds > 0 ? bytes / totalSeconds : 0.0;
+    return result;
+}
+
+// Компактная запись больших величин: 12.3k, 4.56M, 7.89G
+std::string humanReadable(double value) {
+    const char* suffixes[] = { "", "k", "M", "G", "T" };
+    int index = 0;
+    while (value >= 1000.0 && index < 4) {
+        value /= 1000.0;
+        ++index;
+    }
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2) << value << suffixes[index];
+    return stream.str();
+}
+
+// Значение счетчика в ячейке таблицы: "-" для недоступного
+std::string counterCell(const Result& result, Counter counter) {
+    if (!result.counters.has(counter)) {
+        return "-";
+    }
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2) << result.counterPerItem(counter);
+    return stream.str();
+}
+
+// Таблица аппаратных счетчиков: IPC и события на элемент (на итерацию, если элементы не считаются)
+void printCounters(const std::vector<Result>& results) {
+    std::cout << "\n" << cell("Счетчики на элемент", 40, true) << cell("IPC", 8, false)
+        << cell("такты", 12, false) << cell("инструкции", 12, false) << cell("ветвления", 11, false)
+        << cell("L1d", 10, false) << cell("LLC", 10, false) << cell("dTLB", 10, false) << "\n";
+    for (const Result& result : results) {
+        std::string ipc = "-";
+        if (result.counters.has(Counter::Cycles) && result.counters.has(Counter::Instructions)
+            && result.counters[Counter::Cycles] > 0) {
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2)
+                << result.counters[Counter::Instructions] / result.counters[Counter::Cycles];
+            ipc = stream.str();
+        }
+        std::cout << cell(result.name, 40, true) << cell(ipc, 8, false)
+            << cell(counterCell(result, Counter::Cycles), 12, false)
+            << cell(counterCell(result, Counter::Instructions), 12, false)
+            << cell(counterCell(result, Counter::BranchMisses), 11, false)
+            << cell(counterCell(result, Counter::L1dMisses), 10, false)
+            << cell(counterCell(result, Counter::LlcMisses), 10, false)
+            << cell(counterCell(result, Counter::DtlbMisses), 10, false) << "\n";
+    }
+}
+}
+
+// Выравнивание ячейки таблицы; ширина считается в символах UTF-8, а не в байтах
+std::string cell(const std::string& text, std::size_t width, bool alignLeft) {
+    std::size_t length = static_cast<std::size_t>(std::count_if(text.begin(), text.end(),
+        [](char ch) { return (static_cast<unsigned char>(ch) & 0xC0) != 0x80; }));
+    std::string padding(length < width ? width - length : 0, ' ');
+    return alignLeft ? text + padding : padding + text;
+}
+
+bool registerBenchmark(const char* name, BenchmarkFunction function) {
+    registry().push_back({ name, function });
+    return true;
+}
+
+} // namespace bench
+
+// Запуск: expression_parser_bench [--filter=подстрока] [--min-time=секунды] [--json=файл]
+//     [--repetitions=N] [--save-baseline=имя] [--compare=имя] [--baseline-dir=каталог] [--threshold=проценты]
+//     [--counters]
+// --counters добавляет аппаратные счетчики процессора (только поток бенчмарка).
+// Базовый запуск хранится в <каталог>/<имя>.json (по умолчанию bench_baselines).
+// При сравнении код возврата 2, если найдена хотя бы одна регрессия.
+int main(int argc, char** argv) {
+    std::string filter;
+    double minSeconds = 0.5;
+    std::string jsonPath;
+    std::size_t repetitions = 0; // 0 — по умолчанию: 1, а для базы и сравнения 5
+    std::string saveBaseline;
+    std::string compareBaseline;
+    std::filesystem::path baselineDirectory = "bench_baselines";
+    double thresholdPercent = 5.0;
+    bool useCounters = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            if (argument.rfind("--filter=", 0) == 0) {
+                filter = argument.substr(std::strlen("--filter="));
+            }
+            else if (argument.rfind("--min-time=", 0) == 0) {
+                minSeconds = std::stod(argument.substr(std::strlen("--min-time=")));
+            }
+            else if (argument.rfind("--json=", 0) == 0) {
+                jsonPath = argument.substr(std::strlen("--json="));
+            }
+            else if (argument.rfind("--repetitions=", 0) == 0) {
+                repetitions = static_cast<std::size_t>(std::stoul(argument.substr(std::strlen("--repetitions="))));
+            }
+            else if (argument.rfind("--save-baseline=", 0) == 0) {
+                saveBaseline = argument.substr(std::strlen("--save-baseline="));
+            }
+            else if (argument.rfind("--compare=", 0) == 0) {
+                compareBaseline = argument.substr(std::strlen("--compare="));
+            }
+            else if (argument.rfind("--baseline-dir=", 0) == 0) {
+                baselineDirectory = argument.substr(std::strlen("--baseline-dir="));
+            }
+            else if (argument.rfind("--threshold=", 0) == 0) {
+                thresholdPercent = std::stod(argument.substr(std::strlen("--threshold=")));
+            }
+            else if (argument == "--counters") {
+                useCounters = true;
+            }
+            else {
+                std::cerr << "Неизвестный аргумент: " << argument << "\n";
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception&) {
+        std::cerr << "Некорректное числовое значение аргумента\n";
+        return 1;
+    }
+    if (repetitions == 0) {
+        repetitions = saveBaseline.empty() && compareBaseline.empty() ? 1 : 5;
+    }
+
+    // База читается до замеров, чтобы опечатка в имени не стоила целого запуска
+    std::vector<bench::Result> baseline;
+    if (!compareBaseline.empty()) {
+        try {
+            baseline = bench::readJson(baselineDirectory / (compareBaseline + ".json"));
+        }
+        catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+    }
+
+    // Недоступные счетчики не мешают замерам: предупреждаем и продолжаем без них
+    std::unique_ptr<bench::PerfCounters> counters;
+    if (useCounters) {
+        counters = std::make_unique<bench::PerfCounters>();
+        if (!counters->problem().empty()) {
+            std::cerr << "Счетчики процессора: " << counters->problem() << "\n";
+        }
+        if (!counters->anyAvailable()) {
+            counters.reset();
+        }
+    }
+
+    std::cout << bench::cell("Бенчмарк", 40, true) << bench::cell("Итераций", 14, false)
+        << bench::cell("нс/итер", 16, false) << bench::cell("±95%", 10, false)
+        << bench::cell("элем/с", 14, false) << bench::cell("байт/с", 14, false) << "\n";
+
+    std::vector<bench::Result> results;
+    for (const bench::Registration& benchmark : bench::registry()) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        bench::Result result = bench::runBenchmark(benchmark, minSeconds, repetitions, counters.get());
+
+        std::ostringstream nanoseconds;
+        nanoseconds << std::fixed << std::setprecision(1) << result.mean();
+        std::ostringstream margin;
+        if (result.samples.size() > 1) {
+            margin << std::fixed << std::setprecision(1) << result.confidence95() / result.mean() * 100.0 << "%";
+        }
+        else {
+            margin << "-";
+        }
+        std::cout << bench::cell(result.name, 40, true)
+            << bench::cell(std::to_string(result.iterations), 14, false)
+            << bench::cell(nanoseconds.str(), 16, false)
+            << bench::cell(margin.str(), 10, false)
+            << bench::cell(result.itemsPerSecond > 0 ? bench::humanReadable(result.itemsPerSecond) : "-", 14, false)
+            << bench::cell(result.bytesPerSecond > 0 ? bench::humanReadable(result.bytesPerSecond) : "-", 14, false)
+            << "\n";
+        results.push_back(std::move(result));
+    }
+
+    if (counters != nullptr) {
+        bench::printCounters(results);
+    }
+
+    try {
+        if (!jsonPath.empty()) {
+            bench::writeJson(jsonPath, results, minSeconds);
+        }
+        if (!saveBaseline.empty()) {
+            std::filesystem::path path = baselineDirectory / (saveBaseline + ".json");
+            bench::writeJson(path, results, minSeconds);
+            std::cout << "\nБаза сохранена в " << path.string() << "\n";
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+
+    if (!compareBaseline.empty()) {
+        std::size_t regressions = bench::compareResults(baseline, results, thresholdPercent);
+        if (regressions > 0) {
+            std::cout << "\nРегрессий: " << regressions << " (порог " << thresholdPercent << "%)\n";
+            return 2;
+        }
+        std::cout << "\nРегрессий нет (порог " << thresholdPercent << "%)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bench_counters.hpp"
+
+// Небольшой каркас микробенчмарков в стиле Google Benchmark.
+// Бенчмарк — функция void(bench::State&), тело которой крутится в цикле
+// for (auto _ : state) { ... }; число итераций подбирается автоматически,
+// чтобы замер длился не меньше заданного времени.
+namespace bench {
+
+// Состояние одного замера: число итераций, таймер и счетчики обработанного
+class State {
+public:
+    // counters — аппаратные счетчики на время цикла замера (необязательно)
+    explicit State(std::size_t iterations, PerfCounters* counters = nullptr)
+        : iterationCount(iterations), counters(counters) {}
+
+    // Итератор цикла замера: запускает таймер в begin() и останавливает на последней итерации
+    class Iterator {
+    public:
+        // Значение переменной цикла. Тип помечен [[maybe_unused]], как в Google Benchmark,
+        // чтобы for (auto _ : state) не давал предупреждений о неиспользуемой переменной
+        struct [[maybe_unused]] Value {};
+
+        Iterator(State* state, std::size_t remaining) : state(state), remaining(remaining) {}
+
+        bool operator!=(const Iterator&) {
+            if (remaining == 0) {
+                state->stopTimer();
+                return false;
+            }
+            return true;
+        }
+        Iterator& operator++() {
+            --remaining;
+            return *this;
+        }
+        Value operator*() const { return Value(); }
+
+    private:
+        State* state;
+        std::size_t remaining;
+    };
+
+    Iterator begin() {
+        startTimer();
+        return Iterator(this, iterationCount);
+    }
+    Iterator end() { return Iterator(this, 0); }
+
+    // Количество итераций в этом замере
+    std::size_t iterations() const { return iterationCount; }
+
+    // Сколько элементов (выражений, чисел, записей) обработано за весь замер
+    void setItemsProcessed(std::uint64_t items) { items_ = items; }
+    std::uint64_t itemsProcessed() const { return items_; }
+
+    // Сколько байт обработано за весь замер
+    void setBytesProcessed(std::uint64_t bytes) { bytes_ = bytes; }
+    std::uint64_t bytesProcessed() const { return bytes_; }
+
+    // Время, измеренное циклом замера
+    std::chrono::nanoseconds elapsed() const { return elapsedTime; }
+
+private:
+    std::size_t iterationCount;
+    PerfCounters* counters;
+    std::uint64_t items_ = 0;
+    std::uint64_t bytes_ = 0;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::nanoseconds elapsedTime{ 0 };
+
+    // Счетчики включаются до таймера и выключаются после него, чтобы не попасть в замер времени
+    void startTimer() {
+        if (counters != nullptr) {
+            counters->start();
+        }
+        startTime = std::chrono::steady_clock::now();
+    }
+    void stopTimer() {
+        elapsedTime = std::chrono::steady_clock::now() - startTime;
+        if (counters != nullptr) {
+            counters->stop();
+        }
+    }
+};
+
+// Функция бенчмарка
+using BenchmarkFunction = void (*)(State&);
+
+// Регистрирует бенчмарк; используется макросом BENCHMARK
+bool registerBenchmark(const char* name, BenchmarkFunction function);
+
+// Выравнивание ячейки таблицы по ширине width (в символах UTF-8) влево или вправо
+std::string cell(const std::string& text, std::size_t width, bool alignLeft);
+
+// Не дает компилятору выбросить вычисление значения как неиспользуемое
+template <class T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+} // namespace bench
+
+// Регистрация бенчмарка при статической инициализации
+#define BENCHMARK(function) \
+    static const bool function##Registered = ::bench::registerBenchmark(#function, function)
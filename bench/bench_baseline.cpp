@@ -0,0 +1,229 @@
+#include "bench_baseline.hpp"
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace bench {
+
+namespace {
+
+// Критическое значение t-распределения для двустороннего 95% интервала
+double tCritical95(double degreesOfFreedom) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (degreesOfFreedom < 1.0) {
+        return table[0];
+    }
+    std::size_t index = static_cast<std::size_t>(degreesOfFreedom) - 1; // Округление вниз — интервал шире
+    return index < std::size(table) ? table[index] : 1.960;
+}
+
+// Значение ключа "key": число или массив чисел в строке JSON
+std::string_view fieldText(std::string_view line, std::string_view key) {
+    std::string pattern = "\"" + std::string(key) + "\": ";
+    std::size_t start = line.find(pattern);
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    start += pattern.size();
+    std::size_t end = line[start] == '[' ? line.find(']', start) + 1 : line.find_first_of(",}", start);
+    return line.substr(start, end - start);
+}
+
+double parseDouble(std::string_view text) {
+    return std::stod(std::string(text));
+}
+
+std::string formatPercent(double value) {
+    std::ostringstream stream;
+    stream << std::showpos << std::fixed << std::setprecision(1) << value << "%";
+    return stream.str();
+}
+
+std::string formatNanoseconds(double value) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << value;
+    return stream.str();
+}
+
+} // namespace
+
+double Result::mean() const {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    return sum / static_cast<double>(samples.size());
+}
+
+double Result::stddev() const {
+    if (samples.size() < 2) {
+        return 0.0;
+    }
+    double average = mean();
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += (sample - average) * (sample - average);
+    }
+    return std::sqrt(sum / static_cast<double>(samples.size() - 1));
+}
+
+double Result::confidence95() const {
+    if (samples.size() < 2) {
+        return 0.0;
+    }
+    double n = static_cast<double>(samples.size());
+    return tCritical95(n - 1.0) * stddev() / std::sqrt(n);
+}
+
+double Result::counterPerItem(Counter counter) const {
+    double divisor = itemsTotal > 0 ? itemsTotal : iterationsTotal;
+    return divisor > 0 ? counters[counter] / divisor : 0.0;
+}
+
+// Один бенчмарк на строку: readJson разбирает файл построчно.
+// Имена бенчмарков — идентификаторы C++, экранирование им не нужно.
+void writeJson(const std::filesystem::path& path, const std::vector<Result>& results, double minSeconds) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Не удалось открыть файл " + path.string());
+    }
+    out << std::setprecision(17);
+    out << "{\n  \"context\": {\"min_time\": " << minSeconds << "},\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << ", \"ns_per_iteration\": " << result.mean()
+            << ", \"stddev\": " << result.stddev()
+            << ", \"ci95\": " << result.confidence95()
+            << ", \"items_per_second\": " << result.itemsPerSecond
+            << ", \"bytes_per_second\": " << result.bytesPerSecond;
+        // Счетчики на элемент; недоступные не пишутся
+        for (std::size_t j = 0; j < kCounterCount; ++j) {
+            Counter counter = static_cast<Counter>(j);
+            if (result.counters.has(counter)) {
+                out << ", \"" << counterName(counter) << "_per_item\": " << result.counterPerItem(counter);
+            }
+        }
+        out << ", \"samples\": [";
+        for (std::size_t j = 0; j < result.samples.size(); ++j) {
+            out << (j > 0 ? ", " : "") << result.samples[j];
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out) {
+        throw std::runtime_error("Ошибка записи в файл " + path.string());
+    }
+}
+
+std::vector<Result> readJson(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Не удалось открыть файл " + path.string());
+    }
+
+    std::vector<Result> results;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string_view name = fieldText(line, "name");
+        if (name.size() < 2) {
+            continue;
+        }
+        Result result;
+        result.name = std::string(name.substr(1, name.size() - 2));
+        result.iterations = static_cast<std::size_t>(parseDouble(fieldText(line, "iterations")));
+        result.itemsPerSecond = parseDouble(fieldText(line, "items_per_second"));
+        result.bytesPerSecond = parseDouble(fieldText(line, "bytes_per_second"));
+
+        // Файлы без повторов содержат только среднее
+        std::string_view samples = fieldText(line, "samples");
+        if (samples.size() > 2) {
+            std::string_view list = samples.substr(1, samples.size() - 2);
+            while (!list.empty()) {
+                std::size_t comma = list.find(',');
+                result.samples.push_back(parseDouble(list.substr(0, comma)));
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        }
+        else {
+            result.samples.push_back(parseDouble(fieldText(line, "ns_per_iteration")));
+        }
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+std::size_t compareResults(const std::vector<Result>& baseline, const std::vector<Result>& current,
+    double thresholdPercent) {
+    std::cout << "\n" << cell("Бенчмарк", 40, true) << cell("база, нс", 14, false) << cell("сейчас, нс", 14, false)
+        << cell("изменение", 12, false) << cell("±95%", 10, false) << "  Итог\n";
+
+    std::size_t regressions = 0;
+    for (const Result& now : current) {
+        auto found = std::find_if(baseline.begin(), baseline.end(),
+            [&](const Result& base) { return base.name == now.name; });
+        if (found == baseline.end()) {
+            std::cout << cell(now.name, 40, true) << cell("-", 14, false)
+                << cell(formatNanoseconds(now.mean()), 14, false) << cell("", 22, false) << "  нет в базе\n";
+            continue;
+        }
+        const Result& base = *found;
+
+        // Разность средних и ее 95% интервал по Уэлчу, в процентах от базы
+        double baseMean = base.mean();
+        double nowMean = now.mean();
+        double baseVariance = base.stddev() * base.stddev() / static_cast<double>(base.samples.size());
+        double nowVariance = now.stddev() * now.stddev() / static_cast<double>(now.samples.size());
+        double standardError = std::sqrt(baseVariance + nowVariance);
+        double degreesOfFreedom = 1.0;
+        if (standardError > 0 && base.samples.size() > 1 && now.samples.size() > 1) {
+            degreesOfFreedom = std::pow(baseVariance + nowVariance, 2)
+                / (baseVariance * baseVariance / static_cast<double>(base.samples.size() - 1)
+                    + nowVariance * nowVariance / static_cast<double>(now.samples.size() - 1));
+        }
+        double change = (nowMean - baseMean) / baseMean * 100.0;
+        double margin = tCritical95(degreesOfFreedom) * standardError / baseMean * 100.0;
+
+        // С одним повтором разброс неизвестен, и значимость оценить нельзя
+        std::string verdict;
+        bool enoughSamples = base.samples.size() > 1 && now.samples.size() > 1;
+        if (!enoughSamples) {
+            verdict = "мало повторов";
+        }
+        else if (change - margin > thresholdPercent) {
+            verdict = "РЕГРЕССИЯ";
+            ++regressions;
+        }
+        else if (change + margin < -thresholdPercent) {
+            verdict = "ускорение";
+        }
+        else {
+            verdict = "без изменений";
+        }
+
+        std::cout << cell(now.name, 40, true) << cell(formatNanoseconds(baseMean), 14, false)
+            << cell(formatNanoseconds(nowMean), 14, false) << cell(formatPercent(change), 12, false)
+            << cell(enoughSamples ? formatPercent(margin).substr(1) : "-", 10, false) << "  " << verdict << "\n";
+    }
+    return regressions;
+}
+
+} // namespace bench
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "bench_counters.hpp"
+
+// Результаты бенчмарков в JSON и сравнение с сохраненным базовым запуском.
+// Каждый бенчмарк повторяется несколько раз с одним и тем же числом итераций;
+// регрессией считается замедление, которое выходит за порог даже с учетом
+// 95% доверительного интервала разности средних (t-критерий Уэлча).
+namespace bench {
+
+// Результат одного бенчмарка по всем повторам
+struct Result {
+    std::string name;
+    std::size_t iterations = 0;       // Итераций в каждом повторе
+    std::vector<double> samples;      // нс/итерацию в каждом повторе
+    double itemsPerSecond = 0.0;      // По среднему времени
+    double bytesPerSecond = 0.0;
+    double itemsTotal = 0.0;          // Элементов за все повторы (0, если бенчмарк их не считает)
+    double iterationsTotal = 0.0;     // Итераций за все повторы
+    CounterValues counters;           // Сумма аппаратных счетчиков за все повторы
+
+    // Значение счетчика на один элемент (или на итерацию, если элементы не считаются)
+    double counterPerItem(Counter counter) const;
+
+    double mean() const;
+    double stddev() const;            // Выборочное (n - 1); 0 при одном повторе
+    double confidence95() const;      // Полуширина 95% доверительного интервала среднего
+};
+
+// Сохраняет результаты в JSON, чтобы запуски можно было сравнивать между собой
+void writeJson(const std::filesystem::path& path, const std::vector<Result>& results, double minSeconds);
+
+// Читает результаты из JSON, записанного writeJson
+std::vector<Result> readJson(const std::filesystem::path& path);
+
+// Сравнивает текущие результаты с базовыми и печатает таблицу.
+// thresholdPercent — замедление, меньше которого изменение не считается регрессией.
+// Возвращает количество регрессий.
+std::size_t compareResults(const std::vector<Result>& baseline, const std::vector<Result>& current,
+    double thresholdPercent);
+
+} // namespace bench
@@ -0,0 +1,174 @@
+#include "bench_counters.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+namespace {
+
+#ifdef __linux__
+// Тип и конфигурация события perf для счетчика
+struct EventConfig {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+EventConfig eventConfig(Counter counter) {
+    auto cache = [](std::uint64_t id) {
+        return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    switch (counter) {
+    case Counter::Cycles:       return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+    case Counter::Instructions: return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS };
+    case Counter::BranchMisses: return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES };
+    case Counter::L1dMisses:    return { PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D) };
+    case Counter::LlcMisses:    return { PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL) };
+    case Counter::DtlbMisses:   return { PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB) };
+    }
+    return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+}
+
+// Значение счетчика и время, когда он был включен и реально считал
+struct Reading {
+    std::uint64_t value = 0;
+    std::uint64_t enabled = 0;
+    std::uint64_t running = 0;
+};
+
+bool readCounter(int fd, Reading& reading) {
+    std::uint64_t data[3];
+    if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+        return false;
+    }
+    reading = { data[0], data[1], data[2] };
+    return true;
+}
+#endif
+
+} // namespace
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+    case Counter::Cycles:       return "cycles";
+    case Counter::Instructions: return "instructions";
+    case Counter::BranchMisses: return "branch_misses";
+    case Counter::L1dMisses:    return "l1d_misses";
+    case Counter::LlcMisses:    return "llc_misses";
+    case Counter::DtlbMisses:   return "dtlb_misses";
+    }
+    return "?";
+}
+
+bool CounterValues::any() const {
+    for (bool value : available) {
+        if (value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PerfCounters::PerfCounters() {
+    descriptors.fill(-1);
+#ifdef __linux__
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        EventConfig config = eventConfig(static_cast<Counter>(i));
+        perf_event_attr attributes{};
+        attributes.size = sizeof(attributes);
+        attributes.type = config.type;
+        attributes.config = config.config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Только текущий поток, на любом процессоре
+        long fd = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if (fd < 0) {
+            if (failure.empty()) {
+                failure = std::string(counterName(static_cast<Counter>(i))) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        descriptors[i] = static_cast<int>(fd);
+        accumulated.available[i] = true;
+    }
+    if (!anyAvailable()) {
+        failure += " (проверьте kernel.perf_event_paranoid)";
+    }
+#else
+    failure = "perf_event_open доступен только в Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : descriptors) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::anyAvailable() const {
+    return accumulated.any();
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        if (descriptors[i] < 0) {
+            continue;
+        }
+        ioctl(descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+        Reading reading;
+        if (readCounter(descriptors[i], reading)) {
+            startValues[i] = reading.value;
+            startEnabled[i] = reading.enabled;
+            startRunning[i] = reading.running;
+        }
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        if (descriptors[i] < 0) {
+            continue;
+        }
+        Reading reading;
+        bool ok = readCounter(descriptors[i], reading);
+        ioctl(descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (!ok) {
+            continue;
+        }
+
+        // Счетчиков больше, чем регистров PMU: ядро их чередует, и значение
+        // масштабируется на долю времени, когда счетчик реально работал
+        std::uint64_t value = reading.value - startValues[i];
+        std::uint64_t enabled = reading.enabled - startEnabled[i];
+        std::uint64_t running = reading.running - startRunning[i];
+        if (running > 0) {
+            accumulated.values[i] += static_cast<double>(value) * static_cast<double>(enabled) / static_cast<double>(running);
+        }
+    }
+#endif
+}
+
+CounterValues PerfCounters::take() {
+    CounterValues result = accumulated;
+    accumulated.values.fill(0.0);
+    return result;
+}
+
+} // namespace bench
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Аппаратные счетчики процессора на время цикла замера (perf_event_open, только Linux).
+// Каждый счетчик открывается отдельно: если ядро или виртуальная машина не дает
+// какой-то из них, остальные все равно считаются. Если не открылся ни один
+// (например, из-за kernel.perf_event_paranoid), замеры идут как обычно, без счетчиков.
+namespace bench {
+
+enum class Counter : std::uint8_t {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1dMisses,    // Промахи чтения L1 данных
+    LlcMisses,    // Промахи чтения последнего уровня кэша
+    DtlbMisses    // Промахи чтения TLB данных
+};
+
+inline constexpr std::size_t kCounterCount = 6;
+
+// Короткое имя счетчика для таблицы и JSON
+const char* counterName(Counter counter);
+
+// Накопленные значения; недоступные счетчики помечены в available
+struct CounterValues {
+    std::array<double, kCounterCount> values{};
+    std::array<bool, kCounterCount> available{};
+
+    double operator[](Counter counter) const { return values[static_cast<std::size_t>(counter)]; }
+    bool has(Counter counter) const { return available[static_cast<std::size_t>(counter)]; }
+    bool any() const;
+};
+
+// Набор открытых счетчиков текущего потока
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Открылся ли хотя бы один счетчик
+    bool anyAvailable() const;
+
+    // Почему счетчики недоступны (пусто, если открылись все)
+    const std::string& problem() const { return failure; }
+
+    // Запуск и остановка счета; значения накапливаются между вызовами take()
+    void start();
+    void stop();
+
+    // Накопленные значения с поправкой на мультиплексирование; сбрасывает накопленное
+    CounterValues take();
+
+private:
+    std::array<int, kCounterCount> descriptors;
+    std::array<std::uint64_t, kCounterCount> startValues{};
+    std::array<std::uint64_t, kCounterCount> startEnabled{};
+    std::array<std::uint64_t, kCounterCount> startRunning{};
+    CounterValues accumulated;
+    std::string failure;
+};
+
+} // namespace bench
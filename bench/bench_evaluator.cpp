@@ -0,0 +1,207 @@
+// Бенчмарки этапов вычисления: токенизация, разбор, вычисление AST по типам узлов
+// и полный цикл ExpressionEvaluator. Входные выражения берутся из генератора
+// с фиксированным зерном на нескольких глубинах, поэтому запуски сравнимы между собой.
+
+#include "bench.hpp"
+#include "evaluator.hpp"
+#include "fast_expression_generator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Выражений в наборе одной глубины: перебираются по кругу
+constexpr std::size_t kSampleSize = 1024;
+
+// Набор выражений одной глубины и заранее подготовленные данные каждого этапа.
+// В набор попадают только выражения, которые проходят все этапы без ошибки,
+// чтобы в замер не попадала стоимость исключений.
+struct DepthSample {
+    std::string input;                            // Все выражения подряд
+    std::vector<std::string_view> expressions;
+    std::vector<std::vector<expr::Token>> tokens;
+    std::vector<std::unique_ptr<expr::AstNode>> trees;
+};
+
+const DepthSample& depthSample(int depth) {
+    static std::map<int, DepthSample> samples;
+    auto found = samples.find(depth);
+    if (found != samples.end()) {
+        return found->second;
+    }
+
+    GeneratorProfile profile;
+    profile.minDepth = depth;
+    profile.maxDepth = depth;
+    profile.errorProbability = 0.0;
+    profile.divisionByZeroProbability = 0.0;
+    FastExpressionGenerator generator(42 + static_cast<std::uint64_t>(depth), profile);
+
+    DepthSample& sample = samples[depth];
+    std::vector<std::size_t> lengths;
+    std::string line;
+    for (std::size_t index = 0; lengths.size() < kSampleSize; ++index) {
+        line.clear();
+        generator.generateLine(line, index);
+        try {
+            expr::ExpressionEvaluator().evaluate(line);
+        }
+        catch (const std::exception&) {
+            continue; // Например, arcsin от числа вне [-1, 1]
+        }
+        sample.input += line;
+        lengths.push_back(line.size());
+    }
+
+    // Ссылки в input берутся только после того, как строка перестала расти
+    std::size_t offset = 0;
+    for (std::size_t length : lengths) {
+        std::string_view expression = std::string_view(sample.input).substr(offset, length);
+        offset += length;
+        sample.expressions.push_back(expression);
+        sample.tokens.push_back(expr::Tokenizer(expression).tokenize());
+        sample.trees.push_back(expr::Parser(sample.tokens.back()).parse());
+    }
+    return sample;
+}
+
+void tokenize(bench::State& state, int depth) {
+    const DepthSample& sample = depthSample(depth);
+    std::uint64_t bytes = 0;
+    std::size_t index = 0;
+    for (auto _ : state) {
+        std::string_view expression = sample.expressions[index++ % kSampleSize];
+        std::vector<expr::Token> tokens = expr::Tokenizer(expression).tokenize();
+        bench::doNotOptimize(tokens);
+        bytes += expression.size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setBytesProcessed(bytes);
+}
+
+// Parser принимает токены по значению, поэтому копия вектора входит в замер,
+// как и в ExpressionEvaluator (там вектор перемещается, но память уже выделена токенизатором)
+void parse(bench::State& state, int depth) {
+    const DepthSample& sample = depthSample(depth);
+    std::size_t index = 0;
+    for (auto _ : state) {
+        std::unique_ptr<expr::AstNode> tree = expr::Parser(sample.tokens[index++ % kSampleSize]).parse();
+        bench::doNotOptimize(tree);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+void evaluateTree(bench::State& state, int depth) {
+    const DepthSample& sample = depthSample(depth);
+    std::size_t index = 0;
+    for (auto _ : state) {
+        double value = sample.trees[index++ % kSampleSize]->evaluate();
+        bench::doNotOptimize(value);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+void evaluateEndToEnd(bench::State& state, int depth) {
+    const DepthSample& sample = depthSample(depth);
+    expr::ExpressionEvaluator evaluator;
+    std::uint64_t bytes = 0;
+    std::size_t index = 0;
+    for (auto _ : state) {
+        std::string_view expression = sample.expressions[index++ % kSampleSize];
+        double value = evaluator.evaluate(expression);
+        bench::doNotOptimize(value);
+        bytes += expression.size();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setBytesProcessed(bytes);
+}
+
+void tokenizeDepth2(bench::State& state) { tokenize(state, 2); }
+void tokenizeDepth4(bench::State& state) { tokenize(state, 4); }
+void tokenizeDepth8(bench::State& state) { tokenize(state, 8); }
+BENCHMARK(tokenizeDepth2);
+BENCHMARK(tokenizeDepth4);
+BENCHMARK(tokenizeDepth8);
+
+void parseDepth2(bench::State& state) { parse(state, 2); }
+void parseDepth4(bench::State& state) { parse(state, 4); }
+void parseDepth8(bench::State& state) { parse(state, 8); }
+BENCHMARK(parseDepth2);
+BENCHMARK(parseDepth4);
+BENCHMARK(parseDepth8);
+
+void evaluateTreeDepth2(bench::State& state) { evaluateTree(state, 2); }
+void evaluateTreeDepth4(bench::State& state) { evaluateTree(state, 4); }
+void evaluateTreeDepth8(bench::State& state) { evaluateTree(state, 8); }
+BENCHMARK(evaluateTreeDepth2);
+BENCHMARK(evaluateTreeDepth4);
+BENCHMARK(evaluateTreeDepth8);
+
+void evaluatorDepth2(bench::State& state) { evaluateEndToEnd(state, 2); }
+void evaluatorDepth4(bench::State& state) { evaluateEndToEnd(state, 4); }
+void evaluatorDepth8(bench::State& state) { evaluateEndToEnd(state, 8); }
+BENCHMARK(evaluatorDepth2);
+BENCHMARK(evaluatorDepth4);
+BENCHMARK(evaluatorDepth8);
+
+// Вычисление одного узла каждого типа над листьями-числами:
+// стоимость виртуального вызова и самой операции без обхода большого дерева.
+// Узел лежит в списке по указателю на базовый класс, чтобы компилятор
+// не заменил виртуальный вызов прямым.
+std::unique_ptr<expr::AstNode> number(double value) {
+    return std::make_unique<expr::NumberNode>(value);
+}
+
+void evaluateNode(bench::State& state, std::unique_ptr<expr::AstNode> node) {
+    std::vector<std::unique_ptr<expr::AstNode>> nodes;
+    nodes.push_back(std::move(node));
+    bench::doNotOptimize(nodes);
+    std::size_t index = 0;
+    for (auto _ : state) {
+        double value = nodes[index++ % nodes.size()]->evaluate();
+        bench::doNotOptimize(value);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+void nodeNumber(bench::State& state) {
+    evaluateNode(state, number(1.5));
+}
+BENCHMARK(nodeNumber);
+
+void nodeUnaryMinus(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::UnaryNode>('-', number(1.5)));
+}
+BENCHMARK(nodeUnaryMinus);
+
+void nodeBinaryAdd(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::BinaryNode>('+', number(1.5), number(2.25)));
+}
+BENCHMARK(nodeBinaryAdd);
+
+void nodeBinaryMultiply(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::BinaryNode>('*', number(1.5), number(2.25)));
+}
+BENCHMARK(nodeBinaryMultiply);
+
+void nodeBinaryDivide(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::BinaryNode>('/', number(1.5), number(2.25)));
+}
+BENCHMARK(nodeBinaryDivide);
+
+void nodeFunctionSin(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::FunctionNode>("sin", number(0.5)));
+}
+BENCHMARK(nodeFunctionSin);
+
+void nodeFunctionArccos(bench::State& state) {
+    evaluateNode(state, std::make_unique<expr::FunctionNode>("arccos", number(0.5)));
+}
+BENCHMARK(nodeFunctionArccos);
+
+} // namespace
@@ -0,0 +1,96 @@
+// Бенчмарки форматирования чисел для вывода результатов.
+// Сравнивают прежний путь через iostream с std::to_chars в обоих форматах.
+
+#include "bench.hpp"
+#include "number_format.hpp"
+
+#include <cstdio>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Набор значений, похожих на результаты вычислений: небольшие числа,
+// произведения, очень маленькие и очень большие величины
+const std::vector<double>& sampleValues() {
+    static const std::vector<double> values = []() {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<> small(-10.0, 10.0);
+        std::uniform_real_distribution<> exponent(-12.0, 30.0);
+        std::vector<double> result;
+        result.reserve(4096);
+        for (std::size_t i = 0; i < 4096; ++i) {
+            if (i % 4 == 3) {
+                result.push_back(small(gen) * std::pow(10.0, exponent(gen)));
+            }
+            else {
+                result.push_back(small(gen));
+            }
+        }
+        return result;
+    }();
+    return values;
+}
+
+// Прежний путь: поток с std::fixed и setprecision(10)
+void formatIostreamFixed10(bench::State& state) {
+    const std::vector<double>& values = sampleValues();
+    std::ostringstream stream;
+    stream.setf(std::ios::fixed);
+    stream << std::setprecision(10);
+    std::size_t index = 0;
+    for (auto _ : state) {
+        stream.str(std::string());
+        stream << values[index++ % values.size()];
+        bench::doNotOptimize(stream);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(formatIostreamFixed10);
+
+// snprintf("%.10f") в стековый буфер
+void formatSnprintfFixed10(bench::State& state) {
+    const std::vector<double>& values = sampleValues();
+    char buffer[expr::kMaxFormattedNumberLength];
+    std::size_t index = 0;
+    for (auto _ : state) {
+        int length = std::snprintf(buffer, sizeof(buffer), "%.10f", values[index++ % values.size()]);
+        bench::doNotOptimize(length);
+        bench::doNotOptimize(buffer);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(formatSnprintfFixed10);
+
+// std::to_chars, фиксированная точка с 10 знаками (совместимый формат)
+void formatToCharsFixed10(bench::State& state) {
+    const std::vector<double>& values = sampleValues();
+    char buffer[expr::kMaxFormattedNumberLength];
+    std::size_t index = 0;
+    for (auto _ : state) {
+        char* end = expr::formatNumber(buffer, values[index++ % values.size()], expr::NumberFormat::Fixed10);
+        bench::doNotOptimize(end);
+        bench::doNotOptimize(buffer);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(formatToCharsFixed10);
+
+// std::to_chars, кратчайшее точное представление
+void formatToCharsShortest(bench::State& state) {
+    const std::vector<double>& values = sampleValues();
+    char buffer[expr::kMaxFormattedNumberLength];
+    std::size_t index = 0;
+    for (auto _ : state) {
+        char* end = expr::formatNumber(buffer, values[index++ % values.size()], expr::NumberFormat::Shortest);
+        bench::doNotOptimize(end);
+        bench::doNotOptimize(buffer);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(formatToCharsShortest);
+
+} // namespace
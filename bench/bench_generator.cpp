@@ -0,0 +1,49 @@
+// Бенчмарки генератора выражений: прежний рекурсивный генератор на std::string
+// против генератора, дописывающего выражения в один буфер.
+
+#include "bench.hpp"
+#include "expression_generator.hpp"
+#include "fast_expression_generator.hpp"
+
+#include <string>
+
+namespace {
+
+// Прежний путь: новая строка на каждом уровне рекурсии, snprintf для чисел
+void generateStringConcat(bench::State& state) {
+    ExpressionGenerator generator(42);
+    std::uint64_t bytes = 0;
+    std::size_t index = 0;
+    for (auto _ : state) {
+        std::string expression = generator.generate(4 + static_cast<int>(index++ % 5));
+        bytes += expression.size() + 1;
+        bench::doNotOptimize(expression);
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setBytesProcessed(bytes);
+}
+BENCHMARK(generateStringConcat);
+
+// Запись в общий буфер, xoshiro256 и форматирование чисел без snprintf
+void generateIntoBuffer(bench::State& state) {
+    FastExpressionGenerator generator(42);
+    std::string buffer;
+    buffer.reserve(1024 * 1024);
+    std::uint64_t bytes = 0;
+    std::size_t index = 0;
+    for (auto _ : state) {
+        generator.generateLine(buffer, index++);
+        buffer.push_back('\n');
+        if (buffer.size() >= 1024 * 1024) {
+            bytes += buffer.size();
+            buffer.clear();
+        }
+    }
+    bytes += buffer.size();
+    bench::doNotOptimize(buffer);
+    state.setItemsProcessed(state.iterations());
+    state.setBytesProcessed(bytes);
+}
+BENCHMARK(generateIntoBuffer);
+
+} // namespace
@@ -0,0 +1,59 @@
+// Бенчмарки накладных расходов пула потоков на одну задачу:
+// enqueue с std::future против execute без общего состояния.
+
+#include "bench.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Задач между ожиданиями: очередь пула не растет без предела
+constexpr std::size_t kTasksPerWave = 1024;
+
+// Постановка пустой задачи с future; ожидание волны задач входит в замер,
+// поэтому результат — полная стоимость задачи, а не только постановки в очередь
+void threadPoolEnqueue(bench::State& state) {
+    expr::ThreadPool pool(2);
+    std::vector<std::future<int>> futures;
+    futures.reserve(kTasksPerWave);
+    for (auto _ : state) {
+        futures.push_back(pool.enqueue([]() { return 1; }));
+        if (futures.size() == kTasksPerWave) {
+            for (std::future<int>& future : futures) {
+                future.get();
+            }
+            futures.clear();
+        }
+    }
+    for (std::future<int>& future : futures) {
+        future.get();
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(threadPoolEnqueue);
+
+// Постановка пустой задачи без future; завершение отслеживается общим счетчиком
+void threadPoolExecute(bench::State& state) {
+    expr::ThreadPool pool(2);
+    std::atomic<std::size_t> done{ 0 };
+    std::size_t submitted = 0;
+    for (auto _ : state) {
+        pool.execute([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+        if (++submitted % kTasksPerWave == 0) {
+            while (done.load(std::memory_order_relaxed) < submitted) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    while (done.load(std::memory_order_relaxed) < submitted) {
+        std::this_thread::yield();
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(threadPoolExecute);
+
+} // namespace
@@ -0,0 +1,102 @@
+// Бенчмарки сериализации результатов: CSV против NDJSON на одних и тех же записях.
+// Файл пишется во временный каталог; измеряется заполнение буфера и сброс на диск
+// внутри цикла, закрытие файла после цикла в замер не входит.
+
+#include "bench.hpp"
+#include "csv_writer.hpp"
+#include "error_catalog.hpp"
+#include "ndjson_writer.hpp"
+#include "result_writer.hpp"
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Набор записей, похожий на результат обработки сгенерированного файла:
+// длинные выражения, примерно половина строк с ошибками
+struct Sample {
+    Sample();
+
+    expr::ErrorCatalog errors;
+    std::string input;                          // Все выражения подряд, через '\n'
+    std::vector<expr::EvaluationRecord> records;
+};
+
+Sample::Sample() {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> number(-10.0, 10.0);
+    const char* functions[] = { "sin", "cos", "tan", "sqrt" };
+    const std::uint32_t errorCodes[] = {
+        errors.intern("Недопустимый символ в позиции 60"),
+        errors.intern("Неизвестная функция 'arcsinb' на позиции 7"),
+        errors.intern("Деление на ноль"),
+    };
+
+    for (std::size_t i = 0; i < 4096; ++i) {
+        std::string expression = "((" + std::to_string(number(gen)) + " + " + functions[i % 4] + "("
+            + std::to_string(number(gen)) + ")) * (" + std::to_string(number(gen)) + " - \"x\"))";
+        expr::EvaluationRecord record{};
+        record.lineNumber = i + 1;
+        record.offset = input.size();
+        record.length = static_cast<std::uint32_t>(expression.size());
+        if (i % 2 == 0) {
+            record.value = number(gen) * 1000.0;
+        }
+        else {
+            record.errorCode = errorCodes[i % 3];
+        }
+        input += expression;
+        input += '\n';
+        records.push_back(record);
+    }
+}
+
+const Sample& sample() {
+    static const Sample data;
+    return data;
+}
+
+// Общий цикл: пишет записи по кругу через выбранный формат
+void writeRecords(bench::State& state, expr::OutputFormat format, expr::OutputProfile profile) {
+    const Sample& data = sample();
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "expression_parser_bench_writer.tmp";
+    std::unique_ptr<expr::ResultWriter> writer =
+        expr::makeResultWriter(format, path, data.errors, expr::NumberFormat::Fixed10, 0, profile);
+
+    std::size_t index = 0;
+    for (auto _ : state) {
+        const expr::EvaluationRecord& record = data.records[index++ % data.records.size()];
+        writer->writeRecord(record, std::string_view(data.input).substr(record.offset, record.length));
+    }
+
+    writer->close();
+    state.setItemsProcessed(state.iterations());
+    state.setBytesProcessed(writer->stats().bytesWritten);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.parent_path() / (path.stem().string() + "_errors.csv")); // Справочник профиля lean
+}
+
+void writeCsvFull(bench::State& state) {
+    writeRecords(state, expr::OutputFormat::Csv, expr::OutputProfile::Full);
+}
+BENCHMARK(writeCsvFull);
+
+void writeNdjsonFull(bench::State& state) {
+    writeRecords(state, expr::OutputFormat::Ndjson, expr::OutputProfile::Full);
+}
+BENCHMARK(writeNdjsonFull);
+
+void writeCsvLean(bench::State& state) {
+    writeRecords(state, expr::OutputFormat::Csv, expr::OutputProfile::Lean);
+}
+BENCHMARK(writeCsvLean);
+
+void writeNdjsonLean(bench::State& state) {
+    writeRecords(state, expr::OutputFormat::Ndjson, expr::OutputProfile::Lean);
+}
+BENCHMARK(writeNdjsonLean);
+
+} // namespace
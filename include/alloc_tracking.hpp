@@ -0,0 +1,88 @@
+#pragma once
+
+#include "stage_timing.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace expr {
+
+// Учет выделений памяти по этапам обработки.
+// Включается при сборке опцией EXPR_ALLOC_TRACKING (cmake -DEXPR_ALLOC_TRACKING=ON):
+// тогда глобальные operator new/delete заменяются версиями, которые считают
+// выделения и байты в счетчиках текущего потока под текущим этапом.
+// Этап потока задает AllocationStageScope; выделения вне этапов попадают в "прочее".
+#ifdef EXPR_ALLOC_TRACKING
+inline constexpr bool kAllocTrackingEnabled = true;
+#else
+inline constexpr bool kAllocTrackingEnabled = false;
+#endif
+
+// Этапы Stage и отдельная строка для выделений вне этапов
+inline constexpr std::size_t kAllocationBuckets = kStageCount + 1;
+inline constexpr std::size_t kOtherAllocations = kStageCount;
+
+// Выделения одного этапа
+struct AllocationCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Выделения всех потоков по этапам
+struct AllocationReport {
+    std::array<AllocationCounts, kAllocationBuckets> stages;
+};
+
+// Номер строки учета для текущего потока (этап или kOtherAllocations)
+std::size_t currentAllocationBucket();
+
+// Меняет строку учета текущего потока, возвращает прежнюю
+std::size_t exchangeAllocationBucket(std::size_t bucket);
+
+// Складывает счетчики всех потоков
+AllocationReport collectAllocations();
+
+// Обнуляет счетчики всех потоков перед новым измерением
+void resetAllocations();
+
+// Пиковый объем резидентной памяти процесса в байтах (0, если неизвестен)
+std::uint64_t peakResidentBytes();
+
+// Относит выделения текущего потока к этапу до конца области видимости
+// (или до следующего switchTo); затем возвращает прежний этап
+class AllocationStageScope {
+public:
+    explicit AllocationStageScope(Stage stage) {
+        if constexpr (kAllocTrackingEnabled) {
+            previous = exchangeAllocationBucket(static_cast<std::size_t>(stage));
+        }
+        else {
+            (void)stage;
+        }
+    }
+
+    ~AllocationStageScope() {
+        if constexpr (kAllocTrackingEnabled) {
+            exchangeAllocationBucket(previous);
+        }
+    }
+
+    // Переход к следующему этапу внутри той же области
+    void switchTo(Stage stage) {
+        if constexpr (kAllocTrackingEnabled) {
+            exchangeAllocationBucket(static_cast<std::size_t>(stage));
+        }
+        else {
+            (void)stage;
+        }
+    }
+
+    AllocationStageScope(const AllocationStageScope&) = delete;
+    AllocationStageScope& operator=(const AllocationStageScope&) = delete;
+
+private:
+    std::size_t previous = kOtherAllocations;
+};
+
+} // namespace expr
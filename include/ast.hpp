@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -15,6 +16,9 @@ public:
 
     // Рекурсивно вычисляет значение поддерева
     virtual double evaluate() const = 0;
+
+    // Количество узлов поддерева, включая этот
+    virtual std::size_t nodeCount() const = 0;
 };
 
 // Узел, представляющий числовую константу (лист дерева)
@@ -25,6 +29,8 @@ public:
     // Возвращает само число
     double evaluate() const override { return value; }
 
+    std::size_t nodeCount() const override { return 1; }
+
 private:
     double value;
 };
@@ -37,6 +43,8 @@ public:
 
     double evaluate() const override;
 
+    std::size_t nodeCount() const override { return 1 + left->nodeCount() + right->nodeCount(); }
+
 private:
     char op;                        // Символ операции
     std::unique_ptr<AstNode> left;  // Левый операнд
@@ -51,6 +59,8 @@ public:
 
     double evaluate() const override;
 
+    std::size_t nodeCount() const override { return 1 + child->nodeCount(); }
+
 private:
     char op;
     std::unique_ptr<AstNode> child;
@@ -64,6 +74,8 @@ public:
 
     double evaluate() const override;
 
+    std::size_t nodeCount() const override { return 1 + argument->nodeCount(); }
+
 private:
     std::string name;                // Имя функции
     std::unique_ptr<AstNode> argument; // Аргумент функции
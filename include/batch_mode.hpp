@@ -0,0 +1,12 @@
+#pragma once
+
+// Коды завершения неинтерактивного режима
+constexpr int kExitSuccess = 0;     // Все строки вычислены без ошибок
+constexpr int kExitLineErrors = 1;  // Файл обработан, но в части строк ошибки
+constexpr int kExitFailure = 2;     // Неверные аргументы или ошибка ввода-вывода
+
+// Неинтерактивный режим для пакетной обработки и конвейеров:
+// expression_parser [-i вход] [-o выход] [-t потоки] [-f формат] [-q] ...
+// Все настройки задаются ключами, "-" вместо файла — stdin или stdout,
+// сообщения и прогресс идут в stderr. Возвращает код завершения.
+int runBatchMode(int argc, char** argv);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace expr {
+
+// Счетчики записи в файл
+struct WriteStats {
+    std::uint64_t bytesWritten = 0;          // Байт передано в файл
+    std::uint64_t flushCount = 0;            // Количество системных записей буфера
+    std::chrono::nanoseconds writeTime{ 0 }; // Время, проведенное в записи на диск
+
+    // Только для асинхронной записи
+    std::size_t maxQueueDepth = 0;           // Наибольшее число буферов в очереди на запись
+    std::uint64_t queueDepthSum = 0;         // Сумма глубины очереди при каждой передаче буфера
+    std::chrono::nanoseconds stallTime{ 0 }; // Сколько пишущий поток ждал свободный буфер
+
+    // Средняя глубина очереди на момент передачи буфера
+    double averageQueueDepth() const {
+        return flushCount > 0 ? static_cast<double>(queueDepthSum) / static_cast<double>(flushCount) : 0.0;
+    }
+};
+
+// Выходной файл с большим буфером в памяти процесса.
+// Файл открывается один раз, данные копятся в буфере и уходят на диск
+// одной записью при заполнении буфера, по flush() или при закрытии.
+// В асинхронном режиме (asyncBuffers >= 2) заполненные буферы записывает
+// отдельный фоновый поток, а вызывающий поток сразу продолжает заполнять
+// следующий свободный буфер; ждать он будет, только если заняты все буферы.
+class BufferedFile {
+public:
+    // Открывает файл для записи (перезаписывая его); путь "-" — стандартный вывод.
+    // asyncBuffers = 0 — синхронная запись, иначе число буферов для фоновой записи.
+    explicit BufferedFile(const std::filesystem::path& path,
+        std::size_t bufferSize = kDefaultBufferSize,
+        std::size_t asyncBuffers = 0);
+
+    // Дописывает буфер и закрывает файл; ошибки при этом игнорируются
+    ~BufferedFile();
+
+    BufferedFile(const BufferedFile&) = delete;
+    BufferedFile& operator=(const BufferedFile&) = delete;
+
+    // Добавляет текст в буфер
+    void append(std::string_view text);
+
+    // Добавляет один символ в буфер
+    void append(char ch);
+
+    // Возвращает указатель на свободное место в буфере размером не меньше size байт,
+    // чтобы форматировать данные прямо в буфер. После записи нужно вызвать commit().
+    char* reserve(std::size_t size);
+
+    // Подтверждает size байт, записанных по указателю из reserve()
+    void commit(std::size_t size) { active.size += size; }
+
+    // Отправляет содержимое буфера в файл (в асинхронном режиме — в очередь на запись)
+    void flush();
+
+    // Дописывает все буферы и закрывает файл
+    void close();
+
+    // Счетчики записи; полностью актуальны после close()
+    const WriteStats& stats() const { return writeStats; }
+
+    // Байт, уже переданных в файл; можно читать из любого потока во время записи
+    std::uint64_t bytesFlushed() const { return flushedBytes.load(std::memory_order_relaxed); }
+
+    // Размер буфера по умолчанию (1 МБ)
+    static constexpr std::size_t kDefaultBufferSize = 1024 * 1024;
+
+private:
+    // Буфер с данными
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        std::size_t capacity = 0;
+        std::size_t size = 0;
+    };
+
+    std::FILE* file = nullptr;  // Открытый файл
+    Chunk active;               // Буфер, который сейчас заполняется
+    WriteStats writeStats;      // Счетчики записи
+    std::atomic<std::uint64_t> flushedBytes{ 0 }; // Копия bytesWritten для чтения из других потоков
+
+    // Асинхронная запись
+    bool async = false;
+    std::thread writerThread;             // Фоновый поток записи
+    std::deque<Chunk> filled;             // Заполненные буферы в очереди на запись
+    std::vector<Chunk> freeChunks;        // Свободные буферы
+    std::mutex mutex;                     // Защищает очереди и флаг остановки
+    std::condition_variable condition;    // Уведомление о новых и освободившихся буферах
+    bool stopping = false;                // Флаг завершения фонового потока
+    std::exception_ptr writeError;        // Ошибка, возникшая в фоновом потоке
+
+    // Записывает данные в файл мимо буфера
+    void writeDirect(const char* data, std::size_t size);
+
+    // Передает активный буфер фоновому потоку и берет свободный
+    void submitActive();
+
+    // Основной цикл фонового потока записи
+    void writerLoop();
+
+    // Пробрасывает ошибку фонового потока в вызывающий поток
+    void rethrowWriteError();
+};
+
+} // namespace expr
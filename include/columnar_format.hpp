@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Бинарный колоночный формат результатов.
+// Все числа записываются в порядке байт little-endian.
+//
+//   Заголовок:   magic "EXPRCOL1" (8 байт), версия (uint32), резерв (uint32)
+//   Группы строк, у каждой подряд идут столбцы:
+//       номера строк     uint64[rows]
+//       значения         float64[rows] (0 для строк с ошибкой)
+//       битовая маска    uint8[(rows + 7) / 8], бит i = 1, если значение есть
+//       выравнивание до 8 байт
+//       коды ошибок      uint32[rows], 0 — нет ошибки, k — сообщение k-1 из словаря
+//   Подвал:
+//       словарь ошибок   uint32 count, затем count раз: uint32 длина + байты UTF-8
+//       индекс групп     uint64 count, затем count раз ColumnarRowGroupIndex
+//       всего строк      uint64
+//   Концовка:    смещение подвала (uint64), magic "EXPRCOL1"
+namespace expr {
+
+// Сигнатура в начале и в конце файла
+constexpr char kColumnarMagic[8] = { 'E', 'X', 'P', 'R', 'C', 'O', 'L', '1' };
+
+// Текущая версия формата
+constexpr std::uint32_t kColumnarVersion = 1;
+
+// Число строк в группе по умолчанию
+constexpr std::size_t kDefaultRowGroupSize = 65536;
+
+// Запись индекса группы строк в подвале: смещения столбцов от начала файла
+struct ColumnarRowGroupIndex {
+    std::uint64_t rowCount;
+    std::uint64_t lineNumbersOffset;
+    std::uint64_t valuesOffset;
+    std::uint64_t validityOffset;
+    std::uint64_t errorCodesOffset;
+};
+
+} // namespace expr
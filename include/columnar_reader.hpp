@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "columnar_format.hpp"
+#include "number_format.hpp"
+
+namespace expr {
+
+// Столбцы одной группы строк колоночного файла
+struct ColumnarRowGroup {
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<double> values;
+    std::vector<std::uint8_t> validity;
+    std::vector<std::uint32_t> errorCodes;
+
+    // Есть ли значение у строки row
+    bool hasValue(std::size_t row) const { return (validity[row / 8] >> (row % 8)) & 1u; }
+};
+
+// Чтение бинарного колоночного файла результатов (см. columnar_format.hpp).
+// При открытии читается только подвал; группы строк загружаются по запросу.
+class ColumnarReader {
+public:
+    // Открывает файл и читает словарь ошибок и индекс групп
+    explicit ColumnarReader(const std::filesystem::path& path);
+
+    // Общее число строк в файле
+    std::uint64_t totalRows() const { return rowCount; }
+
+    // Число групп строк
+    std::size_t rowGroupCount() const { return rowGroups.size(); }
+
+    // Загружает столбцы группы index
+    ColumnarRowGroup readRowGroup(std::size_t index);
+
+    // Текст ошибки по коду (код 0 — нет ошибки, пустая строка)
+    const std::string& errorMessage(std::uint32_t code) const;
+
+private:
+    std::ifstream input;
+    std::uint64_t rowCount = 0;
+    std::vector<std::string> messages;
+    std::vector<ColumnarRowGroupIndex> rowGroups;
+
+    // Читает size байт с позиции offset
+    void readAt(std::uint64_t offset, void* data, std::size_t size);
+
+    // Проверяет, что столбцы группы лежат в пределах [0, dataEnd)
+    static void checkRowGroup(const ColumnarRowGroupIndex& group, std::uint64_t dataEnd);
+};
+
+// Преобразует колоночный файл в CSV с колонками line,status,result,message.
+// Текст выражений в колоночном формате не хранится, поэтому его в CSV нет.
+// Возвращает количество преобразованных строк.
+std::uint64_t convertColumnarToCsv(const std::filesystem::path& inputPath,
+    const std::filesystem::path& outputPath,
+    NumberFormat numberFormat = NumberFormat::Fixed10);
+
+} // namespace expr
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "buffered_file.hpp"
+#include "columnar_format.hpp"
+#include "result_writer.hpp"
+
+namespace expr {
+
+// Запись результатов в бинарный колоночный формат (см. columnar_format.hpp).
+// Строки копятся в столбцах группы и записываются целой группой;
+// текст выражения не сохраняется, сообщения об ошибках хранятся один раз в словаре —
+// это содержимое ErrorCatalog, коды в записях совпадают с его кодами.
+class ColumnarWriter final : public ResultWriter {
+public:
+    // Открывает файл для записи (перезаписывая его) и пишет заголовок
+    explicit ColumnarWriter(const std::filesystem::path& path,
+        const ErrorCatalog& errors,
+        std::size_t asyncBuffers = 0,
+        std::size_t rowGroupSize = kDefaultRowGroupSize,
+        bool errorsOnly = false);
+
+    // Добавляет результат в текущую группу строк
+    void writeRecord(const EvaluationRecord& record, std::string_view expression) override;
+
+    // Записывает незаконченную группу строк и отправляет данные на диск
+    void flush() override;
+
+    // Записывает последнюю группу, подвал и закрывает файл
+    void close() override;
+
+    // Количество записанных результатов
+    std::uint64_t recordsWritten() const override { return recordCount; }
+
+    // Счетчики записи в файл
+    const WriteStats& stats() const override { return file.stats(); }
+
+    std::uint64_t bytesFlushed() const override { return file.bytesFlushed(); }
+
+private:
+    BufferedFile file;           // Открытый файл с буфером
+    std::size_t rowGroupSize;    // Строк в группе
+    bool errorsOnly;             // Записывать только строки с ошибками
+    std::uint64_t offset = 0;    // Текущее смещение в файле
+    std::uint64_t recordCount = 0;
+    bool closed = false;
+
+    // Столбцы текущей группы
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<double> values;
+    std::vector<std::uint8_t> validity;
+    std::vector<std::uint32_t> errorCodes;
+
+    std::vector<ColumnarRowGroupIndex> rowGroups; // Индекс записанных групп
+
+    // Записывает накопленную группу строк
+    void writeRowGroup();
+
+    // Записывает байты с учетом смещения
+    void writeBytes(const void* data, std::size_t size);
+
+    // Записывает целое или вещественное число как есть
+    template <class T>
+    void writeValue(T value) { writeBytes(&value, sizeof(value)); }
+};
+
+} // namespace expr
@@ -1,20 +1,38 @@
 #pragma once
 
+#include <cstddef>
 #include <iostream>
+#include <string_view>
 
-// ANSI цветовые коды для форматирования вывода в терминал
+#include "alloc_tracking.hpp"
+#include "stage_timing.hpp"
+
+// ANSI цветовые коды для форматирования вывода в терминал.
+// Не константы: disableColors() заменяет их пустыми строками для вывода в файл или канал.
 namespace Color {
-    constexpr const char* RESET = "\033[0m";
-    constexpr const char* BOLD = "\033[1m";
-    constexpr const char* RED = "\033[31m";
-    constexpr const char* GREEN = "\033[32m";
-    constexpr const char* YELLOW = "\033[33m";
-    constexpr const char* BLUE = "\033[34m";
-    constexpr const char* MAGENTA = "\033[35m";
-    constexpr const char* CYAN = "\033[36m";
-    constexpr const char* GRAY = "\033[90m";
+    inline const char* RESET = "\033[0m";
+    inline const char* BOLD = "\033[1m";
+    inline const char* RED = "\033[31m";
+    inline const char* GREEN = "\033[32m";
+    inline const char* YELLOW = "\033[33m";
+    inline const char* BLUE = "\033[34m";
+    inline const char* MAGENTA = "\033[35m";
+    inline const char* CYAN = "\033[36m";
+    inline const char* GRAY = "\033[90m";
 }
 
+// Отключение цветового оформления вывода (до запуска рабочих потоков)
+void disableColors();
+
+// Ширина текста в символах для выравнивания столбцов (UTF-8 считается по символам, а не байтам)
+std::size_t displayWidth(std::string_view text);
+
 // Вывод приветственного заголовка программы
 void printHeader();
 
+
+// Вывод времени по этапам обработки: сумма по потокам, количество и перцентили
+void printStageTimings(const expr::StageTimings& timings);
+
+// Вывод выделений памяти по этапам на одно выражение и пикового объема памяти
+void printAllocationReport(const expr::AllocationReport& report, std::uint64_t expressions);
@@ -1,41 +1,67 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
-#include <optional>
-#include <string>
-#include <vector>
+#include <string_view>
 
-namespace expr {
+#include "buffered_file.hpp"
+#include "number_format.hpp"
+#include "result_writer.hpp"
 
-// Структура для хранения результата вычисления одной строки
-struct EvaluationRecord {
-    std::size_t lineNumber;       // Номер строки в исходном файле
-    std::string expression;       // Исходный текст выражения
-    std::optional<double> value;  // Результат (если вычисление успешно)
-    std::string status;           // Статус (success или error)
-    std::string message;          // Сообщение об ошибке (если есть)
-};
+namespace expr {
 
 // Класс для записи результатов в формате CSV (Comma-Separated Values)
 // Обеспечивает корректное экранирование специальных символов.
-class CsvWriter {
+// Файл остается открытым все время работы, строки копятся в буфере
+// и сбрасываются на диск крупными блоками.
+// Набор столбцов задается профилем:
+//   full   — line,expression,status,result,message
+//   lean   — line,status,result,error_code; тексты ошибок по кодам
+//            записываются рядом в <имя>_errors.csv при закрытии
+//   errors — line,expression,message, только строки с ошибками
+class CsvWriter final : public ResultWriter {
 public:
-    // Конструктор открывает файл для записи (перезаписывая его)
-    explicit CsvWriter(std::filesystem::path targetPath);
+    // Конструктор открывает файл для записи (перезаписывая его) и пишет заголовок.
+    // asyncBuffers >= 2 включает запись на диск в фоновом потоке (см. BufferedFile).
+    explicit CsvWriter(std::filesystem::path targetPath,
+        const ErrorCatalog& errors,
+        NumberFormat format = NumberFormat::Fixed10,
+        std::size_t asyncBuffers = 0,
+        OutputProfile profile = OutputProfile::Full);
 
-    // Записывает пакет результатов в файл
-    void write(const std::vector<EvaluationRecord>& records) const;
-    
-    // Инициализирует файл (записывает заголовок)
-    void initialize() const;
+    // Записывает заголовок CSV
+    void initialize();
     
     // Записывает один результат в файл (для потоковой записи)
-    void writeRecord(const EvaluationRecord& record) const;
+    void writeRecord(const EvaluationRecord& record, std::string_view expression) override;
+
+    // Отправляет накопленные данные на диск
+    void flush() override;
+
+    // Дописывает данные и закрывает файл
+    void close() override;
+
+    // Количество записанных результатов
+    std::uint64_t recordsWritten() const override { return recordCount; }
+
+    // Счетчики записи в файл (байты, число сбросов, время записи, очередь фоновой записи)
+    const WriteStats& stats() const override { return file.stats(); }
+
+    std::uint64_t bytesFlushed() const override { return file.bytesFlushed(); }
 
 private:
     std::filesystem::path path; // Путь к выходному файлу
-    mutable bool headerWritten = false; // Флаг записи заголовка
+    BufferedFile file;          // Открытый файл с буфером
+    NumberFormat numberFormat;  // Формат вывода результатов
+    OutputProfile profile;      // Набор записываемых столбцов и строк
+    bool dictionaryWritten = false; // Справочник ошибок профиля lean уже записан
+    std::uint64_t recordCount = 0; // Количество записанных результатов
+
+    // Записывает целое число прямо в буфер
+    void writeInteger(std::uint64_t value);
+
+    // Записывает справочник ошибок для профиля lean
+    void writeErrorDictionary();
 };
 
-} // namespace expr
\ No newline at end of file
+} // namespace expr
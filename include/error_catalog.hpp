@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace expr {
+
+// Справочник сообщений об ошибках.
+// Каждое различное сообщение хранится один раз и получает числовой код,
+// а записи результатов хранят только код. Код 0 зарезервирован за «нет ошибки».
+// Потокобезопасен: рабочие потоки регистрируют сообщения параллельно.
+class ErrorCatalog {
+public:
+    // Код, означающий отсутствие ошибки
+    static constexpr std::uint32_t kNoError = 0;
+
+    // Возвращает код сообщения, при необходимости регистрируя его
+    std::uint32_t intern(std::string_view message);
+
+    // Текст сообщения по коду (для kNoError — пустая строка).
+    // Строка остается действительной, пока жив справочник.
+    std::string_view message(std::uint32_t code) const;
+
+    // Количество зарегистрированных сообщений (коды 1..size())
+    std::size_t size() const;
+
+private:
+    // Прозрачное хеширование, чтобы искать по string_view без создания std::string
+    struct Hash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+
+    mutable std::shared_mutex mutex;                                          // Чтение параллельно, добавление эксклюзивно
+    std::deque<std::string> messages;                                         // Тексты по порядку кодов; deque не перемещает строки
+    std::unordered_map<std::string_view, std::uint32_t, Hash, std::equal_to<>> codes; // Текст -> код
+};
+
+} // namespace expr
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <string>
+#include <string_view>
 
 namespace expr {
 
@@ -13,7 +13,7 @@ public:
     // Вычисляет значение математического выражения, заданного строкой.
     // Пример: "2 + 2 * 2" -> 6.0
     // Выбрасывает исключения в случае ошибок синтаксиса или вычисления.
-    double evaluate(const std::string& expression) const;
+    double evaluate(std::string_view expression) const;
 };
 
 } // namespace expr
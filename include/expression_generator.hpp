@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <random>
 #include <string>
 #include <vector>
@@ -23,8 +24,12 @@ const double ERROR_PROBABILITY = 0.05;
 // Простой рекурсивный генератор выражений
 class ExpressionGenerator {
 public:
-    ExpressionGenerator() : gen(rd()), 
-        num_dist(-10.0, 10.0), // Небольшие числа для тригонометрии
+    // Генератор со случайным зерном
+    ExpressionGenerator() : ExpressionGenerator((static_cast<std::uint64_t>(std::random_device{}()) << 32) | std::random_device{}()) {}
+
+    // Генератор с заданным зерном: одно и то же зерно дает одни и те же выражения
+    explicit ExpressionGenerator(std::uint64_t seed)
+        : num_dist(-10.0, 10.0), // Небольшие числа для тригонометрии
         op_dist(0, 3), 
         func_dist(0, kFunctions.size() - 1),
         bool_dist(0, 1),
@@ -34,7 +39,11 @@ public:
         pos_dist(0, 100),
         type_roll_depth1_dist(0, 9),
         type_roll_depth2_dist(0, 19),
-        unit_dist(-0.99, 0.99) {}
+        unit_dist(-0.99, 0.99) {
+        // mt19937 принимает 32-битное зерно, поэтому 64-битное передается через seed_seq
+        std::seed_seq sequence{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) };
+        gen.seed(sequence);
+    }
 
     std::string generate(int depth) {
         // Базовый случай: при нулевой или отрицательной глубине всегда возвращаем число
@@ -117,7 +126,6 @@ public:
     }
 
 private:
-    std::random_device rd;
     std::mt19937 gen;
     std::uniform_real_distribution<> num_dist;
     std::uniform_int_distribution<> op_dist;
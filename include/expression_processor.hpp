@@ -1,156 +1,391 @@
 #pragma once
 
-#include "csv_writer.hpp"
+#include "result_writer.hpp"
+#include "alloc_tracking.hpp"
+#include "error_catalog.hpp"
 #include "evaluator.hpp"
+#include "file_utils.hpp"
+#include "input_source.hpp"
+#include "progress_bar.hpp"
+#include "reorder_window.hpp"
+#include "slow_line_tracker.hpp"
+#include "stage_timing.hpp"
 #include "thread_pool.hpp"
+#include "trace_recorder.hpp"
 
+#include <algorithm>
 #include <atomic>
-#include <filesystem>
-#include <fstream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <future>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstddef>
 #include <functional>
 
-// Структура для хранения исходной строки выражения с ее номером
+// Структура для хранения исходной строки выражения с ее номером.
+// Текст — ссылка во входной источник, сама строка не копируется.
 struct ExpressionLine {
     std::size_t number;
-    std::string text;
+    std::uint64_t offset; // Смещение строки во входных данных
+    std::string_view text;
 };
 
-// Потоковое чтение и обработка файла по частям (chunks) для экономии памяти
-// Читает файл порциями и сразу отправляет задачи в пул потоков
-// Обрабатывает futures батчами и вызывает callback для записи результатов
-// Это позволяет обрабатывать файлы любого размера без загрузки всего файла в память
+// Вычисляет одну строку выражения и упаковывает результат в компактную запись.
+// Ошибки токенизации, парсинга и вычисления превращаются в код ошибки справочника.
+// Если задан slowLines, время строки предлагается в отчет о самых медленных строках.
+inline expr::EvaluationRecord evaluateExpressionLine(
+    std::size_t lineNumber,
+    std::uint64_t offset,
+    std::string_view text,
+    const expr::ExpressionEvaluator& evaluator,
+    expr::ErrorCatalog& errors,
+    expr::SlowLineTracker* slowLines = nullptr) {
+    // Отчет ранжируется по процессорному времени потока; настенное время пишется рядом
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t cpuStart = 0;
+    if (slowLines != nullptr) {
+        start = std::chrono::steady_clock::now();
+        cpuStart = expr::threadCpuNanoseconds();
+    }
+
+    expr::EvaluationRecord record;
+    record.lineNumber = lineNumber;
+    record.offset = offset;
+    record.length = static_cast<std::uint32_t>(text.size());
+    record.errorCode = expr::ErrorCatalog::kNoError;
+    record.value = 0.0;
+    try {
+        if (text.empty()) {
+            throw std::runtime_error("Пустая строка");
+        }
+        // Основная логика вычисления
+        record.value = evaluator.evaluate(text);
+    }
+    catch (const std::exception& ex) {
+        record.value = 0.0;
+        record.errorCode = errors.intern(ex.what());
+    }
+    if (slowLines != nullptr) {
+        std::uint64_t cpuNanoseconds = expr::threadCpuNanoseconds() - cpuStart;
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        if (slowLines->qualifies(cpuNanoseconds)) {
+            slowLines->offer(lineNumber, offset, text, cpuNanoseconds,
+                static_cast<std::uint64_t>(elapsed.count()), record.succeeded());
+        }
+    }
+    return record;
+}
+
+// Потоковое чтение и обработка файла без загрузки всего файла в память
+// Читатель раздает строки пулу потоков, рабочие потоки кладут результаты
+// в окно переупорядочивания, а читатель забирает их оттуда по порядку
+// батчами и вызывает callback для записи результатов.
+// Окно фиксированного размера ограничивает память: если самая ранняя строка
+// еще не готова, а окно заполнено, читатель ждет и не читает дальше.
+// Строки берутся из InputSource без копирования; если источник читает канал
+// блоками, каждые chunkSize строк результаты дописываются и блоки освобождаются.
+// slowLines — отчет о самых медленных строках (nullptr — время строк не измеряется).
+// Возвращает количество прочитанных строк.
 template<typename ProcessCallback>
-void processExpressionsStreaming(
-    const std::filesystem::path& path,
+std::size_t processExpressionsStreaming(
+    expr::InputSource& source,
     expr::ExpressionEvaluator& evaluator,
+    expr::ErrorCatalog& errors,
+    expr::SlowLineTracker* slowLines,
     expr::ThreadPool& pool,
-    std::atomic<std::size_t>& completed,
-    std::atomic<std::size_t>& totalLines,
+    ProgressState& progress,
     ProcessCallback&& processBatch,
-    std::size_t chunkSize = 10000,  // Обрабатываем по 10000 строк за раз
-    std::size_t batchSize = 1000) {  // Обрабатываем futures батчами по 1000
+    std::size_t chunkSize = 10000,    // Размер окна и шаг освобождения блоков источника
+    std::size_t batchSize = 1000) {   // Как часто забирать готовые результаты
 
-    std::ifstream input(path);
-    if (!input.is_open()) {
-        throw std::runtime_error("Не удалось открыть входной файл");
-    }
+    expr::ReorderWindow window(chunkSize);
+    std::vector<expr::EvaluationRecord> batch;
+    batch.reserve(chunkSize);
+
+    // Забирает готовые по порядку результаты и передает их в callback
+    auto drainWindow = [&](bool wait) {
+        bool ready = false;
+        {
+            expr::TraceSpan span(wait ? "ожидание результатов" : "сбор результатов");
+            ready = window.takeReady(batch, wait);
+            span.setCount(ready ? batch.size() : 0);
+        }
+        if (ready) {
+            processBatch(batch);
+        }
+    };
+
+    // Дожидается и записывает все результаты до строки lastLine включительно
+    auto drainUpTo = [&](std::size_t lastLine) {
+        while (window.nextLine() <= lastLine) {
+            drainWindow(true);
+        }
+    };
 
-    // Увеличиваем размер буфера для чтения (1 МБ) для ускорения
-    // Важно: pubsetbuf должен быть вызван ДО первого чтения из потока
-    constexpr std::size_t bufferSize = 1024 * 1024;
-    char* fileBuffer = new char[bufferSize];
-    input.rdbuf()->pubsetbuf(fileBuffer, bufferSize);
+    std::string_view line;
+    std::size_t lineNumber = 0;
+    std::size_t sinceDrain = 0;
+    std::size_t submitted = 0; // Строк, уже отданных пулу
 
-    std::vector<ExpressionLine> chunk;
-    chunk.reserve(chunkSize);
-    std::vector<std::future<expr::EvaluationRecord>> futures;
-    futures.reserve(batchSize);
+    // Задачи пула ссылаются на окно, счетчики и справочник ошибок. Если запись результатов
+    // или чтение бросили исключение, нужно дождаться всех отданных строк (их результаты
+    // выбрасываются), иначе оставшиеся в очереди задачи писали бы в уже разрушенное окно.
+    try {
+        while (source.nextLine(line)) {
+            ++lineNumber;
 
-    std::string buffer;
-    std::size_t lineNumber = 1;
+            // Окно заполнено: ждем самую раннюю строку (backpressure)
+            while (!window.hasRoomFor(lineNumber)) {
+                drainWindow(true);
+            }
+
+            ExpressionLine expressionLine{ lineNumber, source.lineOffset(), line };
+            expr::StageClock::time_point queuedAt = expr::stageTimestamp();
+            expr::AllocationStageScope allocationStage(expr::Stage::Queue);
+            pool.execute([expressionLine, queuedAt, slowLines, &evaluator, &errors, &progress, &window]() {
+                expr::recordStageSince(expr::Stage::Queue, queuedAt);
+                expr::TraceSpan span("задача", 1);
+                expr::EvaluationRecord record = evaluateExpressionLine(
+                    expressionLine.number, expressionLine.offset, expressionLine.text, evaluator, errors, slowLines);
+                progress.lineDone(expressionLine.text.size(), !record.succeeded()); // Обновляем прогресс
+                window.put(std::move(record));
+            });
+            ++submitted;
 
-    auto processFuturesBatch = [&]() {
-        if (futures.empty()) return;
+            // Периодически забираем готовые результаты, не дожидаясь заполнения окна
+            if (++sinceDrain >= batchSize) {
+                drainWindow(false);
+                sinceDrain = 0;
+                progress.windowLines.store(lineNumber + 1 - window.nextLine(), std::memory_order_relaxed);
+            }
 
-        // Собираем результаты батча
-        std::vector<expr::EvaluationRecord> batch;
-        batch.reserve(futures.size());
-        for (auto& future : futures) {
-            batch.push_back(future.get());
+            // Строки из блоков запасного пути живут только до release():
+            // дописываем все результаты, прежде чем читать дальше
+            if (!source.stableViews() && lineNumber % chunkSize == 0) {
+                drainUpTo(lineNumber);
+                source.release();
+            }
         }
 
-        // Вызываем callback для обработки батча
-        processBatch(batch);
+        // Дожидаемся оставшихся результатов
+        drainUpTo(lineNumber);
+    }
+    catch (...) {
+        while (window.nextLine() <= submitted) {
+            window.takeReady(batch, true);
+        }
+        throw;
+    }
+    progress.windowLines.store(0, std::memory_order_relaxed);
+    source.release();
+    return lineNumber;
+}
 
-        // Очищаем futures
-        futures.clear();
-        futures.reserve(batchSize);
+// Обработка с записью результатов прямо на место (позиционный вывод).
+// Читатель раздает пулу пачки по batchSize строк, а рабочие потоки сразу передают
+// каждый результат в storeResult — из своего потока и в любом порядке, поэтому
+// окно переупорядочивания и единая точка записи не нужны. storeResult должен быть
+// потокобезопасным и не выбрасывать исключений.
+// Одновременно в работе не больше двух пачек на поток, чтобы очередь пула не росла
+// без предела. Если источник читает канал блоками, каждые chunkSize строк читатель
+// дожидается всех пачек и освобождает блоки.
+// slowLines — отчет о самых медленных строках (nullptr — время строк не измеряется).
+// Возвращает количество прочитанных строк.
+template<typename StoreCallback>
+std::size_t processExpressionsInPlace(
+    expr::InputSource& source,
+    expr::ExpressionEvaluator& evaluator,
+    expr::ErrorCatalog& errors,
+    expr::SlowLineTracker* slowLines,
+    expr::ThreadPool& pool,
+    ProgressState& progress,
+    StoreCallback&& storeResult,
+    std::size_t batchSize = 256,      // Строк в одной задаче пула
+    std::size_t chunkSize = 10000) {  // Шаг освобождения блоков источника
+
+    const std::size_t maxInFlight = pool.size() * 2;
+    std::mutex mutex;
+    std::condition_variable batchDone;
+    std::size_t pending = 0; // Пачек в работе
+
+    // Ждет, пока в работе останется меньше limit пачек
+    auto waitPendingBelow = [&](std::size_t limit) {
+        std::unique_lock<std::mutex> lock(mutex);
+        batchDone.wait(lock, [&]() { return pending < limit; });
     };
 
-    while (std::getline(input, buffer)) {
-        chunk.push_back({ lineNumber++, std::move(buffer) });
-        // Не обновляем totalLines, так как оно уже известно из подсчета
-
-        // Когда накопили достаточно строк, отправляем в обработку
-        if (chunk.size() >= chunkSize) {
-            // Отправляем весь chunk в пул потоков
-            for (const auto& expressionLine : chunk) {
-                futures.emplace_back(pool.enqueue(
-                    [expressionLine, &evaluator, &completed]() -> expr::EvaluationRecord {
-                        expr::EvaluationRecord record;
-                        record.lineNumber = expressionLine.number;
-                        record.expression = expressionLine.text;
-                        try {
-                            if (expressionLine.text.empty()) {
-                                throw std::runtime_error("Пустая строка");
-                            }
-                            // Основная логика вычисления
-                            double value = evaluator.evaluate(expressionLine.text);
-                            record.value = value;
-                            record.status = "success";
-                            record.message = "";
-                        }
-                        catch (const std::exception& ex) {
-                            record.value.reset();
-                            record.status = "error";
-                            record.message = ex.what();
-                        }
-                        completed.fetch_add(1); // Обновляем прогресс
-                        return record;
-                    }));
+    std::vector<ExpressionLine> batch;
+    batch.reserve(batchSize);
 
-                // Когда накопили достаточно futures, обрабатываем батч
-                if (futures.size() >= batchSize) {
-                    processFuturesBatch();
+    auto submitBatch = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        expr::TraceSpan span("постановка в очередь", batch.size());
+        expr::AllocationStageScope allocationStage(expr::Stage::Queue);
+        waitPendingBelow(maxInFlight);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pending;
+        }
+        expr::StageClock::time_point queuedAt = expr::stageTimestamp();
+        pool.execute([lines = std::move(batch), queuedAt, slowLines, &evaluator, &errors, &progress, &storeResult,
+                      &mutex, &batchDone, &pending]() {
+            expr::recordStageSince(expr::Stage::Queue, queuedAt);
+            {
+                expr::TraceSpan span("задача", lines.size());
+                for (const ExpressionLine& line : lines) {
+                    expr::EvaluationRecord record =
+                        evaluateExpressionLine(line.number, line.offset, line.text, evaluator, errors, slowLines);
+                    progress.lineDone(line.text.size(), !record.succeeded()); // Обновляем прогресс
+                    storeResult(record);
                 }
             }
-            // Очищаем chunk для следующей порции
-            chunk.clear();
-            chunk.reserve(chunkSize);
+            // Уведомление под мьютексом: после его освобождения читатель может уже выйти
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+            batchDone.notify_one();
+        });
+        batch = std::vector<ExpressionLine>();
+        batch.reserve(batchSize);
+    };
+
+    std::string_view line;
+    std::size_t lineNumber = 0;
+
+    // Пачки ссылаются на локальные мьютекс и счетчик: при ошибке чтения
+    // дожидаемся всех отданных пачек, прежде чем выйти из функции
+    try {
+        while (source.nextLine(line)) {
+            ++lineNumber;
+            batch.push_back(ExpressionLine{ lineNumber, source.lineOffset(), line });
+            if (batch.size() >= batchSize) {
+                submitBatch();
+            }
+
+            // Строки из блоков запасного пути живут только до release()
+            if (!source.stableViews() && lineNumber % chunkSize == 0) {
+                submitBatch();
+                waitPendingBelow(1);
+                source.release();
+            }
         }
+
+        // Отдаем последнюю неполную пачку
+        submitBatch();
+    }
+    catch (...) {
+        waitPendingBelow(1);
+        throw;
     }
 
-    // Обрабатываем оставшиеся строки (если их меньше chunkSize)
-    if (!chunk.empty()) {
-        for (const auto& expressionLine : chunk) {
-            futures.emplace_back(pool.enqueue(
-                [expressionLine, &evaluator, &completed]() -> expr::EvaluationRecord {
-                    expr::EvaluationRecord record;
-                    record.lineNumber = expressionLine.number;
-                    record.expression = expressionLine.text;
-                    try {
-                        if (expressionLine.text.empty()) {
-                            throw std::runtime_error("Пустая строка");
+    // Дожидаемся всех пачек
+    waitPendingBelow(1);
+    source.release();
+    return lineNumber;
+}
+
+// Параллельное чтение файла по диапазонам байт.
+// Отображенный в память файл делится на диапазоны, выровненные по границам строк;
+// каждый поток пула сам разбирает свой диапазон, токенизирует, парсит и вычисляет его строки.
+// Номера строк внутри диапазона локальные, глобальные номера восстанавливаются
+// по количеству строк в предыдущих диапазонах. Диапазоны передаются в callback
+// строго по порядку, поэтому результат совпадает с последовательным режимом.
+// slowLines — отчет о самых медленных строках (nullptr — время строк не измеряется).
+// Возвращает количество прочитанных строк.
+template<typename ProcessCallback>
+std::size_t processExpressionsByRanges(
+    const expr::InputSource& source,
+    expr::ExpressionEvaluator& evaluator,
+    expr::ErrorCatalog& errors,
+    expr::SlowLineTracker* slowLines,
+    expr::ThreadPool& pool,
+    ProgressState& progress,
+    ProcessCallback&& processBatch,
+    std::uint64_t maxRangeBytes = 16 * 1024 * 1024) {  // Ограничение объема результатов одного диапазона
+
+    if (!source.isMapped()) {
+        throw std::runtime_error("Режим диапазонов требует входной файл, отображаемый в память");
+    }
+
+    // Диапазонов как минимум столько же, сколько потоков, но каждый не больше maxRangeBytes
+    std::string_view data = source.data();
+    std::size_t rangeCount = std::max<std::size_t>(
+        pool.size(), static_cast<std::size_t>((data.size() + maxRangeBytes - 1) / maxRangeBytes));
+    std::vector<ByteRange> ranges = splitIntoLineRanges(data, rangeCount);
+
+    // Одновременно в работе не больше двух диапазонов на поток,
+    // иначе готовые, но еще не записанные результаты займут всю память
+    const std::size_t maxInFlight = pool.size() * 2;
+    std::deque<std::future<std::vector<expr::EvaluationRecord>>> inFlight;
+    std::size_t nextRange = 0;
+    std::size_t linesBefore = 0; // Количество строк в уже записанных диапазонах
+
+    // Задачи ссылаются на счетчики и справочник ошибок вызывающего: если запись результатов
+    // бросила исключение, сначала дожидаемся всех отданных диапазонов
+    try {
+        while (nextRange < ranges.size() || !inFlight.empty()) {
+            while (nextRange < ranges.size() && inFlight.size() < maxInFlight) {
+                ByteRange range = ranges[nextRange++];
+                expr::TraceSpan enqueueSpan("постановка в очередь", range.end - range.begin);
+                expr::AllocationStageScope allocationStage(expr::Stage::Queue);
+                expr::StageClock::time_point queuedAt = expr::stageTimestamp();
+                inFlight.emplace_back(pool.enqueue(
+                    [data, range, queuedAt, slowLines, &evaluator, &errors, &progress]() -> std::vector<expr::EvaluationRecord> {
+                        expr::recordStageSince(expr::Stage::Queue, queuedAt);
+                        expr::TraceSpan span("задача");
+                        std::string_view text = data.substr(
+                            static_cast<std::size_t>(range.begin), static_cast<std::size_t>(range.end - range.begin));
+
+                        // Разбиваем диапазон на строки так же, как std::getline
+                        std::vector<expr::EvaluationRecord> records;
+                        std::size_t localLine = 1;
+                        std::size_t position = 0;
+                        while (position < text.size()) {
+                            std::size_t newline = text.find('\n', position);
+                            if (newline == std::string_view::npos) {
+                                newline = text.size();
+                            }
+                            records.push_back(evaluateExpressionLine(
+                                localLine++, range.begin + position,
+                                text.substr(position, newline - position), evaluator, errors, slowLines));
+                            progress.lineDone(newline - position, !records.back().succeeded()); // Обновляем прогресс
+                            position = newline + 1;
                         }
-                        // Основная логика вычисления
-                        double value = evaluator.evaluate(expressionLine.text);
-                        record.value = value;
-                        record.status = "success";
-                        record.message = "";
-                    }
-                    catch (const std::exception& ex) {
-                        record.value.reset();
-                        record.status = "error";
-                        record.message = ex.what();
-                    }
-                    completed.fetch_add(1); // Обновляем прогресс
-                    return record;
-                }));
-
-            // Когда накопили достаточно futures, обрабатываем батч
-            if (futures.size() >= batchSize) {
-                processFuturesBatch();
+                        span.setCount(records.size());
+                        return records;
+                    }));
             }
-        }
-    }
 
-    // Обрабатываем оставшиеся futures
-    processFuturesBatch();
+            // Ждем самый ранний диапазон и переводим его номера строк в глобальные
+            std::vector<expr::EvaluationRecord> records;
+            {
+                expr::TraceSpan span("ожидание результатов");
+                records = inFlight.front().get();
+                span.setCount(records.size());
+            }
+            inFlight.pop_front();
+            for (expr::EvaluationRecord& record : records) {
+                record.lineNumber += linesBefore;
+            }
+            if (slowLines != nullptr && !records.empty()) {
+                slowLines->addLineOffset(records.front().offset, records.back().offset + 1, linesBefore);
+            }
+            linesBefore += records.size();
 
-    delete[] fileBuffer;
+            processBatch(records);
+        }
+    }
+    catch (...) {
+        for (std::future<std::vector<expr::EvaluationRecord>>& pending : inFlight) {
+            pending.wait();
+        }
+        throw;
+    }
+    return linesBefore;
 }
-
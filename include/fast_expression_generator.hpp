@@ -0,0 +1,220 @@
+// Генератор выражений без выделения памяти на каждое подвыражение.
+// Форма выражений задается профилем нагрузки (см. generator_profile.hpp); профиль
+// по умолчанию повторяет ExpressionGenerator. Выражения дописываются прямо в один
+// растущий буфер: без промежуточных строк, без snprintf, ошибки вносятся на месте.
+//
+
+#pragma once
+
+#include "expression_generator.hpp"
+#include "generator_profile.hpp"
+#include "random_streams.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class FastExpressionGenerator {
+public:
+    explicit FastExpressionGenerator(std::uint64_t seed, const GeneratorProfile& profile = GeneratorProfile())
+        : random(seed), profile(profile) {
+        // Веса переводятся в накопленные доли, чтобы выбор стоил одного числа из [0, 1)
+        double nodeSum = profile.binaryWeight + profile.functionWeight + profile.numberWeight;
+        binaryThreshold = profile.binaryWeight / nodeSum;
+        functionThreshold = (profile.binaryWeight + profile.functionWeight) / nodeSum;
+        accumulate(profile.operatorWeights, operatorThresholds, 4);
+        accumulate(profile.functionWeights, functionThresholds, 5);
+    }
+
+    // Дописывает в конец out строку номер index (без '\n'): одно или несколько
+    // подвыражений глубины профиля или повтор предыдущей строки
+    void generateLine(std::string& out, std::size_t index) {
+        bool remember = profile.duplicateProbability > 0.0;
+        if (remember && !previousLine.empty() && random.unit() < profile.duplicateProbability) {
+            out.append(previousLine);
+            return;
+        }
+
+        std::size_t start = out.size();
+        int depth = profile.minDepth + static_cast<int>(index % static_cast<std::size_t>(profile.maxDepth - profile.minDepth + 1));
+        int terms = profile.minTerms
+            + static_cast<int>(random.below(static_cast<std::uint32_t>(profile.maxTerms - profile.minTerms + 1)));
+        for (int term = 0; term < terms; ++term) {
+            if (term > 0) {
+                out.push_back(' ');
+                out.push_back(kOperations[pick(operatorThresholds, 4)]);
+                out.push_back(' ');
+            }
+            generate(out, depth);
+        }
+
+        if (remember) {
+            previousLine.assign(out, start, std::string::npos);
+        }
+    }
+
+    // Дописывает в конец out одно выражение глубины depth
+    void generate(std::string& out, int depth) {
+        std::size_t start = out.size();
+
+        // Базовый случай: при нулевой или отрицательной глубине всегда число
+        if (depth <= 0) {
+            appendNumber(out, randomNumber());
+            return;
+        }
+
+        // При глубине 1: функция от числа или просто число
+        if (depth == 1) {
+            if (random.unit() < profile.leafFunctionProbability) {
+                appendFunction(out, depth);
+                introduceError(out, start);
+            }
+            else {
+                appendNumber(out, randomNumber());
+            }
+            return;
+        }
+
+        // При глубине >= 2: бинарная операция, функция или число по весам профиля
+        double typeRoll = random.unit();
+        if (typeRoll < binaryThreshold) {
+            char op = kOperations[pick(operatorThresholds, 4)];
+            out.push_back('(');
+            generate(out, depth - 1);
+            out.push_back(' ');
+            out.push_back(op);
+            out.push_back(' ');
+            if (op == '/') {
+                // С заданной вероятностью делаем деление на ноль (ошибка),
+                // иначе делитель — число не слишком близкое к нулю
+                if (random.unit() < profile.divisionByZeroProbability) {
+                    out.push_back('0');
+                }
+                else {
+                    double divisor = randomNumber();
+                    appendNumber(out, std::abs(divisor) < 0.1 ? 1.0 : divisor);
+                }
+            }
+            else {
+                generate(out, depth - 1);
+            }
+            out.push_back(')');
+            introduceError(out, start);
+        }
+        else if (typeRoll < functionThreshold) {
+            appendFunction(out, depth);
+            introduceError(out, start);
+        }
+        else {
+            appendNumber(out, randomNumber());
+        }
+    }
+
+private:
+    Xoshiro256 random;
+    GeneratorProfile profile;
+    double binaryThreshold = 0.0;   // Доля бинарных операций среди узлов
+    double functionThreshold = 0.0; // Доля бинарных операций и функций
+    double operatorThresholds[4] = {};
+    double functionThresholds[5] = {};
+    std::string previousLine;       // Последняя строка, если профиль повторяет строки
+
+    static constexpr char kOperations[4] = { '+', '-', '*', '/' };
+
+    // Накопленные доли весов
+    static void accumulate(const double* weights, double* thresholds, std::size_t count) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += weights[i];
+        }
+        double running = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            running += weights[i];
+            thresholds[i] = running / sum;
+        }
+    }
+
+    // Выбор индекса по накопленным долям
+    std::size_t pick(const double* thresholds, std::size_t count) {
+        double roll = random.unit();
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            if (roll < thresholds[i]) {
+                return i;
+            }
+        }
+        return count - 1;
+    }
+
+    double randomNumber() {
+        return random.between(profile.numberMin, profile.numberMax);
+    }
+
+    // func(аргумент); для arcsin/arccos аргумент — число из [-0.99, 0.99]
+    void appendFunction(std::string& out, int depth) {
+        const std::string& func = kFunctions[pick(functionThresholds, 5)];
+        out.append(func);
+        out.push_back('(');
+        if (func == "arcsin" || func == "arccos") {
+            appendNumber(out, random.between(-0.99, 0.99));
+        }
+        else if (depth <= 1) {
+            appendNumber(out, randomNumber());
+        }
+        else {
+            generate(out, depth - 1);
+        }
+        out.push_back(')');
+    }
+
+    // Число с двумя знаками после точки, как "%.2f", без snprintf
+    static void appendNumber(std::string& out, double value) {
+        long long cents = std::llround(value * 100.0);
+        if (cents < 0) {
+            out.push_back('-');
+            cents = -cents;
+        }
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        char* cursor = end;
+        *--cursor = static_cast<char>('0' + cents % 10);
+        *--cursor = static_cast<char>('0' + (cents / 10) % 10);
+        *--cursor = '.';
+        long long whole = cents / 100;
+        do {
+            *--cursor = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while (whole > 0);
+        out.append(cursor, static_cast<std::size_t>(end - cursor));
+    }
+
+    // Вносит ошибку в только что дописанное выражение out[start, end) на месте
+    void introduceError(std::string& out, std::size_t start) {
+        if (random.unit() >= profile.errorProbability) {
+            return; // Без ошибки
+        }
+
+        std::size_t length = out.size() - start;
+        switch (random.below(3)) {
+        case 0: { // Незакрытая скобка — убираем последнюю закрывающую скобку
+            std::size_t close = std::string_view(out).substr(start).rfind(')');
+            if (close != std::string_view::npos) {
+                out.erase(start + close, 1);
+            }
+            break;
+        }
+        case 1: // Лишний печатный символ посередине выражения
+            if (length > 2) {
+                out.insert(start + length / 2, 1, static_cast<char>(32 + random.below(95)));
+            }
+            break;
+        case 2: // Дополнительная открывающая скобка без закрывающей
+            if (length > 1) {
+                out.insert(start + random.below(101) % length, 1, '(');
+            }
+            break;
+        default:
+            break;
+        }
+    }
+};
@@ -1,13 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// Быстрый подсчет количества строк в файле
-// Читает файл блоками и считает символы новой строки
-std::size_t countLinesInFile(const std::filesystem::path& path);
+// Подсчет символов новой строки в блоке памяти (векторизованный memchr)
+std::size_t countNewlines(std::string_view data);
+
+// Подсчет строк в данных; последняя строка может не заканчиваться '\n'
+std::size_t countLines(std::string_view data);
+
+// Диапазон байт файла [begin, end)
+struct ByteRange {
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+// Разбиение данных файла на rangeCount диапазонов, выровненных по границам строк.
+// Каждый диапазон (кроме, возможно, последнего) заканчивается символом '\n',
+// поэтому строки никогда не разрезаются между диапазонами.
+std::vector<ByteRange> splitIntoLineRanges(std::string_view data, std::size_t rangeCount);
 
 // Поиск корневой директории проекта (ищет папку tests или файл CMakeLists.txt)
 std::filesystem::path findProjectRoot();
@@ -0,0 +1,64 @@
+// Профили нагрузки генератора выражений.
+// Профиль задает форму выражений: глубину, число слагаемых в строке, доли операций,
+// функций и ошибок, повторы строк. Значения по умолчанию повторяют прежний генератор.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct GeneratorProfile {
+    std::string name = "default";
+
+    // Глубина выражения: minDepth + (номер строки % (maxDepth - minDepth + 1))
+    int minDepth = 4;
+    int maxDepth = 8;
+
+    // Число подвыражений верхнего уровня в строке, соединенных операциями
+    int minTerms = 1;
+    int maxTerms = 1;
+
+    // Выбор узла при глубине >= 2 (веса, не обязаны давать в сумме 1)
+    double binaryWeight = 16.0;
+    double functionWeight = 3.0;
+    double numberWeight = 1.0;
+
+    // Вероятность функции от числа при глубине 1
+    double leafFunctionProbability = 0.3;
+
+    // Веса операций + - * /
+    double operatorWeights[4] = { 1.0, 1.0, 1.0, 1.0 };
+
+    // Веса функций в порядке kFunctions: sin, cos, tan, arcsin, arccos
+    double functionWeights[5] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+    // Диапазон чисел
+    double numberMin = -10.0;
+    double numberMax = 10.0;
+
+    // Вероятность внести ошибку в подвыражение и вероятность делителя 0
+    double errorProbability = 0.05;
+    double divisionByZeroProbability = 0.015;
+
+    // Вероятность повторить предыдущую строку целиком
+    double duplicateProbability = 0.0;
+
+    // Проверяет согласованность значений, при ошибке бросает std::runtime_error
+    void validate() const;
+};
+
+// Имена встроенных профилей
+const std::vector<std::string_view>& generatorProfileNames();
+
+// Встроенный профиль по имени: default, shallow-wide, very-deep, trig-heavy,
+// error-heavy, duplicate-heavy, huge-line
+GeneratorProfile namedGeneratorProfile(std::string_view name);
+
+// Загружает профиль из файла параметров вида "ключ = значение".
+// Строки, начинающиеся с '#', и пустые строки пропускаются. Ключ profile задает
+// встроенный профиль, поверх которого применяются остальные ключи (по умолчанию default).
+GeneratorProfile loadGeneratorProfile(const std::filesystem::path& path);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace expr {
+
+// Источник входных строк без лишнего копирования.
+// Обычный файл отображается в память целиком (mmap), и строки выдаются как
+// std::string_view прямо в отображение — они действительны, пока жив источник.
+// Для каналов и устройств, которые нельзя отобразить, используется запасной
+// путь: файл читается блоками, а строки указывают в эти блоки. Такие строки
+// действительны только до вызова release().
+class InputSource {
+public:
+    // Открывает файл: отображает его в память или, если это невозможно, читает блоками.
+    // Путь "-" означает стандартный ввод.
+    explicit InputSource(const std::filesystem::path& path);
+    ~InputSource();
+
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    // Файл отображен в память целиком
+    bool isMapped() const { return mapped; }
+
+    // Строки остаются действительными до уничтожения источника (а не до release())
+    bool stableViews() const { return mapped; }
+
+    // Все содержимое файла (только для отображенного файла)
+    std::string_view data() const { return { mappedData, mappedSize }; }
+
+    // Считывает следующую строку без символа '\n'.
+    // Возвращает false, когда строки закончились.
+    bool nextLine(std::string_view& line);
+
+    // Смещение от начала входных данных последней выданной строки
+    std::uint64_t lineOffset() const { return lastLineOffset; }
+
+    // Текст по смещению и длине во входных данных. Для запасного пути
+    // текст должен лежать в блоке, который еще не освобожден release().
+    std::string_view text(std::uint64_t offset, std::size_t length) const;
+
+    // Разрешает освободить блоки, в которые указывают уже выданные строки.
+    // Для отображенного файла ничего не делает.
+    void release();
+
+private:
+    // Блок данных запасного пути чтения
+    struct Block {
+        std::unique_ptr<char[]> bytes;
+        std::size_t capacity = 0;
+        std::size_t size = 0;
+        std::uint64_t baseOffset = 0; // Смещение начала блока во входных данных
+    };
+
+    bool mapped = false;
+    const char* mappedData = nullptr;
+    std::size_t mappedSize = 0;
+    std::size_t position = 0; // Позиция чтения в отображении или в текущем блоке
+    std::uint64_t lastLineOffset = 0; // Смещение последней выданной строки
+
+    int openedFd = -1;                      // Дескриптор, открытый mapFile для запасного пути
+    std::FILE* stream = nullptr;            // Поток запасного пути
+    bool streamEnded = false;               // Поток прочитан до конца
+    std::vector<Block> blocks;              // Блоки, на которые могут ссылаться выданные строки
+
+    // Размер блока запасного пути чтения
+    static constexpr std::size_t kBlockSize = 4 * 1024 * 1024;
+
+    // Пытается отобразить файл в память
+    bool mapFile(const std::filesystem::path& path);
+
+    // Дочитывает данные в новый блок, перенося туда незавершенную строку.
+    // Возвращает false, если данных больше нет.
+    bool refill();
+};
+
+} // namespace expr
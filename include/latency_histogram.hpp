@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace expr {
+
+// Гистограмма длительностей в наносекундах с логарифмическими корзинами.
+// Каждая степень двойки делится на 8 корзин, поэтому перцентили считаются
+// с погрешностью не больше 12.5% при постоянном объеме памяти.
+// Не потокобезопасна: у каждого потока своя гистограмма, в конце они объединяются.
+class LatencyHistogram {
+public:
+    // Добавляет одно измерение
+    void record(std::uint64_t nanoseconds) {
+        ++buckets[bucketIndex(nanoseconds)];
+        ++total;
+        sum += nanoseconds;
+        if (nanoseconds > maximum) {
+            maximum = nanoseconds;
+        }
+    }
+
+    // Добавляет измерения другой гистограммы
+    void merge(const LatencyHistogram& other);
+
+    // Значение, не больше которого доля quantile измерений (0.5 — медиана)
+    std::uint64_t percentile(double quantile) const;
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t totalNanoseconds() const { return sum; }
+    std::uint64_t max() const { return maximum; }
+
+private:
+    static constexpr std::size_t kSubBuckets = 8;    // Корзин на степень двойки
+    static constexpr std::size_t kLinearLimit = 16;  // Значения меньше — каждое в своей корзине
+    static constexpr std::size_t kBucketCount = kLinearLimit + (64 - 4) * kSubBuckets;
+
+    std::array<std::uint64_t, kBucketCount> buckets{};
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t maximum = 0;
+
+    // Номер корзины значения
+    static std::size_t bucketIndex(std::uint64_t value);
+
+    // Середина диапазона значений корзины
+    static std::uint64_t bucketValue(std::size_t index);
+};
+
+} // namespace expr
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+// Ограничение нагрузочного теста: по времени или по количеству выражений
+struct LoadTestLimit {
+    double seconds = 10.0;          // Длительность теста, если количество не задано
+    std::size_t expressionCount = 0; // Количество выражений (0 — тест по времени)
+};
+
+// Нагрузочный режим: генераторы выражений передают их пулу вычисления
+// через ограниченную очередь в памяти, без записи на диск
+void runLoadTestMode();
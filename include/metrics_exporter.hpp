@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace expr {
+
+// Снимок показателей обработки для экспорта
+struct MetricsSample {
+    std::uint64_t linesProcessed = 0;
+    std::uint64_t linesFailed = 0;
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t poolQueueDepth = 0;   // Задач в очереди пула
+    std::uint64_t windowLines = 0;      // Строк в окне переупорядочивания
+};
+
+// Периодическая выгрузка показателей в файл текстового формата Prometheus
+// (для textfile collector из node_exporter). Фоновый поток каждые interval
+// вызывает sampler, пишет файл во временный рядом и переименовывает его,
+// чтобы сборщик никогда не прочитал файл наполовину.
+// sampler вызывается из фонового потока и должен читать только атомарные счетчики.
+class MetricsExporter {
+public:
+    MetricsExporter(std::filesystem::path path, std::chrono::milliseconds interval,
+        std::function<MetricsSample()> sampler);
+
+    // Останавливает поток; последний снимок записывается с running = 0
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Останавливает поток и записывает последний снимок. Повторный вызов ничего не делает.
+    void stop();
+
+private:
+    std::filesystem::path path;
+    std::chrono::milliseconds interval;
+    std::function<MetricsSample()> sampler;
+    std::chrono::steady_clock::time_point started;
+
+    // Скорость считается по разнице с прошлым снимком
+    MetricsSample previous;
+    std::chrono::steady_clock::time_point previousTime;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+
+    // Пишет файл показателей; ошибки записи не прерывают обработку
+    void write(bool running);
+};
+
+} // namespace expr
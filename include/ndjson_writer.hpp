@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "buffered_file.hpp"
+#include "number_format.hpp"
+#include "result_writer.hpp"
+
+namespace expr {
+
+// Запись результатов в формате NDJSON: один JSON-объект на строку.
+// Поля записываются прямо в буфер файла, без временных строк:
+//   full   — {"line":1,"expression":"...","status":"error","result":null,"message":"..."}
+//   lean   — {"line":1,"status":"success","result":2.5,"error_code":0}
+//   errors — {"line":1,"expression":"...","message":"..."}, только строки с ошибками
+// Строки экранируются по правилам JSON (кавычки, обратная косая черта,
+// управляющие символы), а не заменой кавычек, как в CSV.
+class NdjsonWriter final : public ResultWriter {
+public:
+    // Открывает файл для записи (перезаписывая его).
+    // asyncBuffers >= 2 включает запись на диск в фоновом потоке (см. BufferedFile).
+    explicit NdjsonWriter(const std::filesystem::path& path,
+        const ErrorCatalog& errors,
+        NumberFormat format = NumberFormat::Fixed10,
+        std::size_t asyncBuffers = 0,
+        OutputProfile profile = OutputProfile::Full);
+
+    // Записывает один результат в буфер
+    void writeRecord(const EvaluationRecord& record, std::string_view expression) override;
+
+    // Отправляет накопленные данные на диск
+    void flush() override;
+
+    // Дописывает данные и закрывает файл
+    void close() override;
+
+    // Количество записанных результатов
+    std::uint64_t recordsWritten() const override { return recordCount; }
+
+    // Счетчики записи в файл
+    const WriteStats& stats() const override { return file.stats(); }
+
+    std::uint64_t bytesFlushed() const override { return file.bytesFlushed(); }
+
+private:
+    BufferedFile file;             // Открытый файл с буфером
+    NumberFormat numberFormat;     // Формат вывода результатов
+    OutputProfile profile;         // Набор записываемых полей и строк
+    std::uint64_t recordCount = 0; // Количество записанных результатов
+
+    // Записывает строку JSON в кавычках с экранированием
+    void writeString(std::string_view text);
+
+    // Записывает целое число
+    void writeInteger(std::uint64_t value);
+
+    // Записывает результат: число или null (JSON не допускает inf и nan)
+    void writeValue(const EvaluationRecord& record);
+};
+
+} // namespace expr
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+
+namespace expr {
+
+// Формат вывода числовых результатов
+enum class NumberFormat {
+    Fixed10,  // Фиксированная точка, 10 знаков после точки (совместимо с прежним выводом)
+    Shortest  // Кратчайшее представление, которое читается обратно в то же самое число
+};
+
+// Максимальная длина числа в любом из форматов:
+// до 309 цифр целой части у double, знак, точка и 10 знаков дробной части
+constexpr std::size_t kMaxFormattedNumberLength = 330;
+
+// Форматирует число в [first, first + kMaxFormattedNumberLength) без локалей и потоков.
+// std::to_chars дает точное округление, поэтому Fixed10 совпадает с printf("%.10f").
+// Возвращает указатель на позицию сразу за последним символом.
+inline char* formatNumber(char* first, double value, NumberFormat format) {
+    char* last = first + kMaxFormattedNumberLength;
+    std::to_chars_result result = format == NumberFormat::Fixed10
+        ? std::to_chars(first, last, value, std::chars_format::fixed, 10)
+        : std::to_chars(first, last, value);
+    return result.ptr;
+}
+
+} // namespace expr
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+
+#include "number_format.hpp"
+#include "result_writer.hpp"
+
+// Способ чтения входного файла
+enum class ReadMode {
+    Sequential,  // Один поток читает файл построчно и раздает строки пулу
+    ByteRanges   // Файл делится на диапазоны байт, каждый поток читает свой диапазон
+};
+
+// Дополнительные настройки обработки файла.
+// Значения по умолчанию соответствуют обычному интерактивному режиму.
+struct ProcessingOptions {
+    ReadMode readMode = ReadMode::Sequential; // Способ чтения входного файла
+    bool exactLineCount = false;              // Заранее считать строки (лишний проход по файлу)
+    expr::NumberFormat numberFormat = expr::NumberFormat::Fixed10; // Формат чисел в результатах
+    std::size_t writeBuffers = 3;             // Буферов фоновой записи (0 — запись в потоке чтения)
+    expr::OutputFormat outputFormat = expr::OutputFormat::Csv; // Формат файла результатов
+    expr::OutputProfile outputProfile = expr::OutputProfile::Full; // Набор столбцов и строк в результатах
+    std::filesystem::path tracePath;          // Файл трассировки Chrome (пустой — не записывать)
+    std::size_t slowLineCount = 0;            // Строк в отчете о самых медленных (0 — без отчета)
+    std::filesystem::path metricsPath;        // Файл метрик Prometheus (пустой — не записывать)
+    std::chrono::seconds metricsInterval{ 5 }; // Период обновления файла метрик
+};
@@ -2,8 +2,31 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <ostream>
 
-// Функция отображения прогресс-бара.
-// Запускается в отдельном потоке.
-void displayProgress(std::atomic<std::size_t>& completed, std::size_t total);
+// Счетчики прогресса обработки, общие для рабочих потоков и потока отображения
+struct ProgressState {
+    std::atomic<std::size_t> completedLines{ 0 };   // Обработано строк
+    std::atomic<std::uint64_t> completedBytes{ 0 }; // Обработано байт входа (с переводами строк)
+    std::atomic<std::size_t> failedLines{ 0 };      // Из них строк с ошибкой
+    std::atomic<std::size_t> windowLines{ 0 };      // Строк в окне переупорядочивания (отданы пулу, не записаны)
+    std::atomic<bool> finished{ false };            // Обработка завершена
+
+    // Отмечает обработанную строку длиной lineLength (без '\n')
+    void lineDone(std::size_t lineLength, bool failed = false) {
+        completedLines.fetch_add(1, std::memory_order_relaxed);
+        completedBytes.fetch_add(lineLength + 1, std::memory_order_relaxed);
+        if (failed) {
+            failedLines.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
 
+// Функция отображения прогресс-бара.
+// Запускается в отдельном потоке и работает до установки state.finished.
+// Если известно точное число строк (totalLines > 0), прогресс считается по строкам,
+// иначе по обработанным байтам относительно размера файла (totalBytes, 0 — неизвестен).
+// Шкала выводится в out: в std::cout в интерактивном режиме и в std::cerr,
+// когда стандартный вывод занят результатами.
+void displayProgress(const ProgressState& state, std::uint64_t totalBytes, std::size_t totalLines, std::ostream& out);
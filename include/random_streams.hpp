@@ -0,0 +1,84 @@
+// Детерминированные потоки случайных чисел для генератора выражений.
+// Из одного пользовательского зерна выводятся независимые зерна для блоков,
+// поэтому результат зависит только от зерна, а не от числа потоков.
+
+#pragma once
+
+#include <cstdint>
+
+// SplitMix64: быстрый генератор с 64-битным состоянием.
+// Используется для вывода зерен, а не как основной генератор.
+class SplitMix64 {
+public:
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        state += kGoldenGamma;
+        return mix(state);
+    }
+
+    // Перемешивание 64-битного значения (финализатор SplitMix64)
+    static std::uint64_t mix(std::uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // Шаг состояния (дробная часть золотого сечения)
+    static constexpr std::uint64_t kGoldenGamma = 0x9E3779B97F4A7C15ull;
+
+private:
+    std::uint64_t state;
+};
+
+// Зерно потока stream, выведенное из общего зерна: stream-е значение SplitMix64(seed).
+// Вычисляется сразу, без прохода по предыдущим потокам.
+inline std::uint64_t deriveStreamSeed(std::uint64_t seed, std::uint64_t stream) {
+    return SplitMix64::mix(seed + (stream + 1) * SplitMix64::kGoldenGamma);
+}
+
+// xoshiro256**: быстрый генератор с 256-битным состоянием для генерации выражений.
+// Состояние заполняется из зерна через SplitMix64, как рекомендуют авторы.
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(std::uint64_t seed) {
+        SplitMix64 mixer(seed);
+        for (std::uint64_t& word : state) {
+            word = mixer.next();
+        }
+    }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Целое число в [0, bound), bound < 2^32 (умножение со сдвигом вместо деления)
+    std::uint32_t below(std::uint32_t bound) {
+        return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+
+    // Вещественное число в [0, 1) из старших 53 бит
+    double unit() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // Вещественное число в [low, high)
+    double between(double low, double high) {
+        return low + (high - low) * unit();
+    }
+
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t value, int shift) {
+        return (value << shift) | (value >> (64 - shift));
+    }
+};
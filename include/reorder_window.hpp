@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "result_writer.hpp"
+
+namespace expr {
+
+// Окно переупорядочивания результатов фиксированного размера.
+// Рабочие потоки кладут записи в ячейку lineNumber % capacity в любом порядке,
+// читатель забирает их строго по возрастанию номеров строк.
+// Память ограничена capacity записями: пока самая ранняя строка не готова,
+// новые строки в окно не помещаются, и читатель ждет (backpressure).
+class ReorderWindow {
+public:
+    // capacity — максимальное число строк в работе, firstLine — номер первой строки
+    explicit ReorderWindow(std::size_t capacity, std::size_t firstLine = 1);
+
+    // Помещает готовую запись в окно (вызывается из рабочих потоков).
+    // Номер строки должен находиться в пределах окна, см. hasRoomFor().
+    void put(EvaluationRecord&& record);
+
+    // Перемещает в out все готовые записи, идущие подряд начиная с nextLine().
+    // При wait = true сначала ждет готовности самой ранней строки.
+    // Возвращает true, если хотя бы одна запись была забрана.
+    bool takeReady(std::vector<EvaluationRecord>& out, bool wait);
+
+    // Можно ли уже отправлять в работу строку lineNumber
+    bool hasRoomFor(std::size_t lineNumber) const;
+
+    // Номер следующей строки, которую ожидает читатель
+    std::size_t nextLine() const;
+
+    // Размер окна
+    std::size_t capacity() const { return slots.size(); }
+
+private:
+    // Ячейка окна: запись и признак ее готовности
+    struct Slot {
+        EvaluationRecord record;
+        bool ready = false;
+    };
+
+    std::vector<Slot> slots;           // Кольцевой буфер ячеек
+    std::size_t next;                  // Номер следующей строки для выдачи
+    mutable std::mutex mutex;          // Мьютекс для синхронизации доступа к ячейкам
+    std::condition_variable condition; // Уведомление о готовности самой ранней строки
+};
+
+} // namespace expr
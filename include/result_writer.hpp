@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+#include "buffered_file.hpp"
+#include "error_catalog.hpp"
+#include "number_format.hpp"
+
+namespace expr {
+
+// Статус вычисления строки
+enum class EvaluationStatus : std::uint8_t {
+    Success,
+    Error
+};
+
+// Компактный результат вычисления одной строки (32 байта).
+// Текст выражения не хранится: запись ссылается на него смещением и длиной
+// во входных данных, а сообщение об ошибке — кодом в ErrorCatalog.
+// Тексты подставляются только при записи результата.
+struct EvaluationRecord {
+    std::uint64_t lineNumber; // Номер строки в исходном файле
+    std::uint64_t offset;     // Смещение выражения во входных данных
+    std::uint32_t length;     // Длина выражения в байтах
+    std::uint32_t errorCode;  // Код ошибки в ErrorCatalog (kNoError при успехе)
+    double value;             // Результат (имеет смысл только при успехе)
+
+    // Статус вычисления определяется кодом ошибки
+    EvaluationStatus status() const {
+        return errorCode == ErrorCatalog::kNoError ? EvaluationStatus::Success : EvaluationStatus::Error;
+    }
+    bool succeeded() const { return errorCode == ErrorCatalog::kNoError; }
+};
+
+static_assert(sizeof(EvaluationRecord) == 32, "EvaluationRecord должен оставаться компактным");
+
+// Текстовое имя статуса для текстовых форматов
+inline std::string_view statusName(EvaluationStatus status) {
+    return status == EvaluationStatus::Success ? "success" : "error";
+}
+
+// Формат файла результатов
+enum class OutputFormat {
+    Csv,     // Текстовый CSV
+    Columnar, // Бинарный колоночный формат для аналитики (см. ColumnarWriter)
+    Ndjson,   // JSON-объект на строку (см. NdjsonWriter)
+    Slots     // Запись фиксированного размера на строку (см. SlotWriter)
+};
+
+// Набор данных в файле результатов
+enum class OutputProfile {
+    Full,      // Все столбцы, включая текст выражения (совместимый)
+    Lean,      // Номер строки, статус, результат и код ошибки, без текста
+    ErrorsOnly // Только строки с ошибками
+};
+
+// Название профиля для статистики
+inline std::string_view profileName(OutputProfile profile) {
+    switch (profile) {
+    case OutputProfile::Lean:
+        return "lean";
+    case OutputProfile::ErrorsOnly:
+        return "errors";
+    case OutputProfile::Full:
+    default:
+        return "full";
+    }
+}
+
+// Общий интерфейс потоковой записи результатов.
+// Записи передаются строго по порядку строк из одного потока.
+// Сообщения об ошибках берутся из справочника по коду в момент записи.
+class ResultWriter {
+public:
+    explicit ResultWriter(const ErrorCatalog& errors) : errors(errors) {}
+    virtual ~ResultWriter() = default;
+
+    // Записывает один результат; expression — текст выражения из входных данных
+    virtual void writeRecord(const EvaluationRecord& record, std::string_view expression) = 0;
+
+    // Отправляет накопленные данные на диск
+    virtual void flush() = 0;
+
+    // Дописывает данные и закрывает файл
+    virtual void close() = 0;
+
+    // Количество записанных результатов
+    virtual std::uint64_t recordsWritten() const = 0;
+
+    // Счетчики записи в файл
+    virtual const WriteStats& stats() const = 0;
+
+    // Байт, уже записанных в файл; можно читать из любого потока во время записи
+    virtual std::uint64_t bytesFlushed() const = 0;
+
+protected:
+    const ErrorCatalog& errors; // Справочник сообщений об ошибках
+};
+
+// Создает объект записи результатов в нужном формате.
+// asyncBuffers >= 2 включает запись на диск в фоновом потоке (см. BufferedFile).
+// Профиль определяет набор столбцов CSV; отбор только ошибок действует для всех форматов.
+// Позиционный формат здесь не создается: ему нужно заранее известное число строк (см. SlotWriter).
+std::unique_ptr<ResultWriter> makeResultWriter(
+    OutputFormat format,
+    const std::filesystem::path& path,
+    const ErrorCatalog& errors,
+    NumberFormat numberFormat = NumberFormat::Fixed10,
+    std::size_t asyncBuffers = 0,
+    OutputProfile profile = OutputProfile::Full);
+
+} // namespace expr
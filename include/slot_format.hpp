@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Позиционный бинарный формат результатов: запись фиксированного размера на строку.
+// Запись строки N лежит по смещению kSlotHeaderSize + (N - 1) * kSlotSize,
+// поэтому рабочие потоки пишут результаты сразу на место, в любом порядке.
+// Все числа записываются в порядке байт little-endian.
+//
+//   Заголовок (32 байта): magic "EXPRSLT1" (8 байт), версия (uint32),
+//                         размер записи (uint32), число записей (uint64),
+//                         смещение словаря ошибок (uint64)
+//   Записи:               EvaluationRecord по 32 байта: номер строки (uint64),
+//                         смещение и длина выражения во входном файле (uint64, uint32),
+//                         код ошибки (uint32), значение (float64).
+//                         Номер строки 0 — запись не заполнена.
+//   Словарь ошибок:       uint32 count, затем count раз: uint32 длина + байты UTF-8;
+//                         код k соответствует сообщению k-1
+namespace expr {
+
+// Сигнатура в начале файла
+constexpr char kSlotMagic[8] = { 'E', 'X', 'P', 'R', 'S', 'L', 'T', '1' };
+
+// Текущая версия формата
+constexpr std::uint32_t kSlotVersion = 1;
+
+// Размер заголовка и одной записи
+constexpr std::size_t kSlotHeaderSize = 32;
+constexpr std::size_t kSlotSize = 32;
+
+// Заголовок файла
+struct SlotFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t slotSize;
+    std::uint64_t slotCount;
+    std::uint64_t dictionaryOffset;
+};
+
+static_assert(sizeof(SlotFileHeader) == kSlotHeaderSize, "Заголовок позиционного файла должен занимать 32 байта");
+
+} // namespace expr
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "number_format.hpp"
+#include "slot_format.hpp"
+
+namespace expr {
+
+// Проверяет, начинается ли файл с сигнатуры позиционного формата
+bool isSlotFile(const std::filesystem::path& path);
+
+// Преобразует позиционный файл (см. slot_format.hpp) в CSV с колонками line,status,result,message.
+// Незаполненные записи пропускаются. Возвращает количество преобразованных строк.
+std::uint64_t convertSlotsToCsv(const std::filesystem::path& inputPath,
+    const std::filesystem::path& outputPath,
+    NumberFormat numberFormat = NumberFormat::Fixed10);
+
+} // namespace expr
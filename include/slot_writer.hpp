@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "result_writer.hpp"
+#include "slot_format.hpp"
+
+namespace expr {
+
+// Запись результатов в позиционный формат (см. slot_format.hpp).
+// Файл заранее получает полный размер (fallocate) и отображается в память;
+// результат строки копируется прямо в ее запись, без упорядочивания и мьютекса.
+// store() можно вызывать из нескольких потоков одновременно — каждая строка
+// пишется в свое место. Число строк должно быть известно заранее.
+class SlotWriter final : public ResultWriter {
+public:
+    // Создает файл на slotCount записей (перезаписывая его) и отображает его в память
+    SlotWriter(const std::filesystem::path& path, const ErrorCatalog& errors, std::uint64_t slotCount);
+    ~SlotWriter();
+
+    SlotWriter(const SlotWriter&) = delete;
+    SlotWriter& operator=(const SlotWriter&) = delete;
+
+    // Кладет результат в запись его строки. Потокобезопасно.
+    // Возвращает false, если номер строки вне заранее заданного числа записей.
+    bool store(const EvaluationRecord& record);
+
+    // Текст выражения не сохраняется: запись хранит его смещение во входном файле
+    void writeRecord(const EvaluationRecord& record, std::string_view expression) override;
+
+    // Отправляет измененные страницы на диск
+    void flush() override;
+
+    // Записывает заголовок и словарь ошибок и закрывает файл
+    void close() override;
+
+    // Количество записанных результатов
+    std::uint64_t recordsWritten() const override { return recordCount.load(std::memory_order_relaxed); }
+
+    // Счетчики записи в файл: объем и время сброса отображения на диск
+    const WriteStats& stats() const override { return writeStats; }
+
+    // Записи попадают в отображение сразу, поэтому считаются по числу сохраненных
+    std::uint64_t bytesFlushed() const override {
+        return sizeof(SlotFileHeader) + recordsWritten() * sizeof(EvaluationRecord);
+    }
+
+private:
+    int fd = -1;                 // Дескриптор выходного файла
+    char* slots = nullptr;       // Отображение записей в память
+    std::size_t mappedSize = 0;  // Размер отображения
+    std::uint64_t slotCount = 0; // Число записей в файле
+    std::atomic<std::uint64_t> recordCount{ 0 };
+    WriteStats writeStats;
+    bool closed = false;
+
+    // Снимает отображение и закрывает файл, не бросая исключений
+    void release() noexcept;
+};
+
+} // namespace expr
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace expr {
+
+// Одна из самых медленных строк
+struct SlowLine {
+    std::size_t lineNumber = 0;
+    std::uint64_t offset = 0;       // Смещение строки во входных данных
+    std::uint32_t length = 0;       // Длина строки в байтах
+    std::size_t nodeCount = 0;      // Узлов AST (0, если строка не разбирается)
+    std::uint64_t cpuNanoseconds = 0;  // Процессорное время потока на токенизацию, разбор и вычисление
+    std::uint64_t wallNanoseconds = 0; // То же по настенным часам (включает вытеснение потока)
+    bool succeeded = false;
+    std::string preview;            // Начало строки для отчета
+};
+
+// Хранит K строк с наибольшим процессорным временем вычисления (min-куча по времени).
+// Ранжирование идет по времени потока, а не по настенным часам: иначе в отчет
+// попадали бы строки, во время которых поток был вытеснен, а не тяжелые выражения.
+// Рабочие потоки сначала сравнивают время с порогом без блокировки —
+// порог равен самому быстрому времени в заполненной куче, поэтому
+// мьютекс берется только для строк, которые действительно попадут в отчет.
+class SlowLineTracker {
+public:
+    explicit SlowLineTracker(std::size_t capacity);
+
+    // Может ли строка с таким процессорным временем попасть в отчет
+    bool qualifies(std::uint64_t cpuNanoseconds) const {
+        return cpuNanoseconds > threshold.load(std::memory_order_relaxed);
+    }
+
+    // Предлагает строку; число узлов и начало текста считаются только здесь.
+    // Потокобезопасно.
+    void offer(std::size_t lineNumber, std::uint64_t offset, std::string_view text,
+        std::uint64_t cpuNanoseconds, std::uint64_t wallNanoseconds, bool succeeded);
+
+    // Переводит номера строк с offset в [begin, end) из локальных в глобальные:
+    // в режиме диапазонов рабочий поток знает только номер строки внутри диапазона
+    void addLineOffset(std::uint64_t begin, std::uint64_t end, std::size_t linesBefore);
+
+    // Строки от самой медленной к самой быстрой
+    std::vector<SlowLine> slowest() const;
+
+    // Записывает отчет CSV: rank,line,length,nodes,cpu_us,wall_us,status,expression
+    void writeReport(const std::filesystem::path& path) const;
+
+    // Длина начала строки, сохраняемого для отчета
+    static constexpr std::size_t kPreviewLength = 200;
+
+private:
+    std::size_t capacity;
+    mutable std::mutex mutex;
+    std::vector<SlowLine> heap;                 // Самая быстрая из сохраненных — в heap.front()
+    std::atomic<std::uint64_t> threshold{ 0 };  // Время heap.front(), когда куча заполнена
+};
+
+// Процессорное время текущего потока в наносекундах (CLOCK_THREAD_CPUTIME_ID).
+// Где такого счетчика нет, возвращает время steady_clock.
+std::uint64_t threadCpuNanoseconds();
+
+} // namespace expr
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace expr {
+
+// Замер времени по этапам обработки.
+// Включается при сборке опцией EXPR_STAGE_TIMING (cmake -DEXPR_STAGE_TIMING=ON);
+// без нее StageScope и recordStageSince пустые и полностью убираются компилятором.
+// Каждый поток пишет в свои гистограммы без блокировок, объединяются они
+// только в collectStageTimings().
+#ifdef EXPR_STAGE_TIMING
+inline constexpr bool kStageTimingEnabled = true;
+#else
+inline constexpr bool kStageTimingEnabled = false;
+#endif
+
+// Этапы, время которых измеряется
+enum class Stage : std::uint8_t {
+    Tokenize,  // Tokenizer::tokenize
+    Parse,     // Parser::parse
+    Evaluate,  // AstNode::evaluate
+    Queue,     // От постановки задачи в пул до начала ее выполнения
+    Write      // Передача готовых результатов в ResultWriter
+};
+
+inline constexpr std::size_t kStageCount = 5;
+
+// Название этапа для статистики
+const char* stageName(Stage stage);
+
+using StageClock = std::chrono::steady_clock;
+
+// Гистограммы длительностей всех этапов
+struct StageTimings {
+    std::array<LatencyHistogram, kStageCount> stages;
+
+    const LatencyHistogram& operator[](Stage stage) const { return stages[static_cast<std::size_t>(stage)]; }
+    LatencyHistogram& operator[](Stage stage) { return stages[static_cast<std::size_t>(stage)]; }
+
+    void merge(const StageTimings& other);
+};
+
+// Гистограммы текущего потока
+StageTimings& threadStageTimings();
+
+// Объединяет гистограммы всех потоков, в том числе уже завершившихся.
+// Вызывать, когда измеряемые потоки простаивают.
+StageTimings collectStageTimings();
+
+// Обнуляет гистограммы всех потоков перед новым измерением
+void resetStageTimings();
+
+// Момент начала измерения (без EXPR_STAGE_TIMING — пустое значение без вызова часов)
+inline StageClock::time_point stageTimestamp() {
+    if constexpr (kStageTimingEnabled) {
+        return StageClock::now();
+    }
+    else {
+        return {};
+    }
+}
+
+// Записывает длительность этапа от момента start до текущего
+inline void recordStageSince(Stage stage, StageClock::time_point start) {
+    if constexpr (kStageTimingEnabled) {
+        std::chrono::nanoseconds elapsed = StageClock::now() - start;
+        threadStageTimings()[stage].record(static_cast<std::uint64_t>(elapsed.count()));
+    }
+    else {
+        (void)stage;
+        (void)start;
+    }
+}
+
+// Измеряет время жизни области видимости как один интервал этапа
+class StageScope {
+public:
+    explicit StageScope(Stage stage) : stage(stage), start(stageTimestamp()) {}
+    ~StageScope() { recordStageSince(stage, start); }
+
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    Stage stage;
+    StageClock::time_point start;
+};
+
+} // namespace expr
@@ -25,6 +25,18 @@ public:
     template <class Func, class... Args>
     std::future<std::invoke_result_t<Func, Args...>> enqueue(Func&& func, Args&&... args);
 
+    // Добавляет задачу без результата и без std::future.
+    // Дешевле enqueue: не создает packaged_task и общее состояние future.
+    // Задача не должна выбрасывать исключений — их некому передать.
+    template <class Func>
+    void execute(Func&& func);
+
+    // Количество рабочих потоков пула
+    std::size_t size() const { return workers.size(); }
+
+    // Задач в очереди, еще не взятых рабочими потоками
+    std::size_t queuedTasks();
+
 private:
     std::vector<std::thread> workers;          // Рабочие потоки
     std::queue<std::function<void()>> tasks;   // Очередь задач
@@ -60,4 +72,18 @@ inline std::future<std::invoke_result_t<Func, Args...>> ThreadPool::enqueue(Func
     return res;
 }
 
+// Реализация шаблона execute
+template <class Func>
+inline void ThreadPool::execute(Func&& func) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stop) {
+            throw std::runtime_error("Пул потоков уже остановлен");
+        }
+        tasks.emplace(std::forward<Func>(func));
+    }
+
+    condition.notify_one(); // Будим один из спящих потоков
+}
+
 } 
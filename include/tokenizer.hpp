@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "token.hpp"
@@ -12,8 +13,9 @@ namespace expr {
 // Игнорирует пробельные символы.
 class Tokenizer {
 public:
-    // Конструктор принимает исходную строку выражения
-    explicit Tokenizer(std::string sourceText);
+    // Конструктор принимает исходную строку выражения (без копирования).
+    // Строка должна оставаться живой, пока работает токенизатор.
+    explicit Tokenizer(std::string_view sourceText);
 
     // Основной метод запуска токенизации
     // Возвращает вектор токенов, заканчивающийся токеном End
@@ -21,7 +23,7 @@ public:
     std::vector<Token> tokenize();
 
 private:
-    const std::string source; // Исходная строка
+    const std::string_view source; // Исходная строка
     std::size_t index = 0;    // Текущая позиция чтения
 
     // Проверка достижения конца строки
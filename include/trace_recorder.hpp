@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace expr {
+
+// Запись интервалов работы потоков для просмотра в chrome://tracing или Perfetto.
+// Каждый поток пишет события только в свой буфер, без блокировок; буферы
+// объединяются в JSON формата Chrome Trace Event в writeChromeTrace().
+// Пока запись не включена, TraceSpan стоит одну проверку флага.
+namespace trace_detail {
+inline std::atomic<bool> active{ false };
+}
+
+// Включена ли запись трассировки
+inline bool tracingEnabled() {
+    return trace_detail::active.load(std::memory_order_relaxed);
+}
+
+// Очищает буферы всех потоков и включает запись.
+// Вызывать, пока потоки, пишущие события, простаивают.
+void startTracing();
+
+// Выключает запись и сохраняет события всех потоков в файл Chrome Trace JSON.
+// Возвращает количество записанных событий.
+std::size_t writeChromeTrace(const std::filesystem::path& path);
+
+// Имя текущего потока в трассировке (по умолчанию "поток N"); может быть любой
+// строкой — при сохранении оно экранируется для JSON
+void setTraceThreadName(std::string name);
+
+// Записывает одно событие текущего потока: name — строковый литерал без кавычек
+// и обратных косых черт, count — необязательное число (строк, байт) для подписи
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end, std::uint64_t count);
+
+// Интервал от создания до уничтожения объекта как одно событие трассировки
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::uint64_t count = 0) : name(name), count(count) {
+        if (tracingEnabled()) {
+            enabled = true;
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (enabled) {
+            recordTraceEvent(name, start, std::chrono::steady_clock::now(), count);
+        }
+    }
+
+    // Уточняет число для подписи, когда оно известно только в конце интервала
+    void setCount(std::uint64_t value) { count = value; }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t count;
+    bool enabled = false;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace expr
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "generator_profile.hpp"
+#include "loadtest_mode.hpp"
+#include "processing_options.hpp"
+
 #include <filesystem>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 // Безопасный парсинг числа из строки
@@ -16,12 +21,28 @@ std::filesystem::path selectOutputFile(const std::filesystem::path& inputPath);
 // Интерактивный ввод количества потоков
 std::size_t selectThreadCount();
 
+// Интерактивный выбор дополнительных настроек обработки
+ProcessingOptions selectProcessingOptions();
+
 // Запрос продолжения работы с другим файлом
 bool askContinue();
 
 // Интерактивный ввод количества выражений для генерации
 std::size_t askExpressionCount();
 
+// Интерактивный ввод зерна генератора (пустой ввод — случайное зерно)
+std::uint64_t askGeneratorSeed();
+
+// Интерактивный выбор профиля нагрузки генератора: имя встроенного профиля
+// или путь к файлу параметров (пустой ввод — профиль default)
+GeneratorProfile selectGeneratorProfile();
+
+// Интерактивный выбор ограничения нагрузочного теста: по времени или по количеству
+LoadTestLimit askLoadTestLimit();
+
+// Интерактивный ввод количества потоков генерации
+std::size_t askProducerCount();
+
 // Интерактивный выбор имени файла для генерации
 std::filesystem::path selectGeneratedFileName(std::size_t expressionCount);
 
@@ -0,0 +1,175 @@
+#include "alloc_tracking.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace expr {
+
+namespace {
+
+// Счетчики одного потока. Пишет только владелец; атомики нужны, чтобы
+// collectAllocations мог читать их из другого потока.
+struct ThreadAllocationSlot {
+    std::array<std::atomic<std::uint64_t>, kAllocationBuckets> allocations{};
+    std::array<std::atomic<std::uint64_t>, kAllocationBuckets> bytes{};
+};
+
+// Слоты выделяются из статического массива: в operator new нельзя выделять память.
+// Потоки сверх предела делят последний слот, там счетчики увеличиваются атомарно.
+constexpr std::size_t kMaxSlots = 256;
+ThreadAllocationSlot slots[kMaxSlots];
+std::atomic<std::size_t> slotsUsed{ 0 };
+
+// Этап текущего потока: constinit, чтобы не было динамической инициализации
+constinit thread_local std::size_t threadBucket = kOtherAllocations;
+
+#ifdef EXPR_ALLOC_TRACKING
+// Слот потока и учет нужны только заменам operator new ниже
+constinit thread_local ThreadAllocationSlot* threadSlot = nullptr;
+
+ThreadAllocationSlot& slotForThread() {
+    if (threadSlot == nullptr) {
+        std::size_t index = slotsUsed.fetch_add(1, std::memory_order_relaxed);
+        threadSlot = &slots[index < kMaxSlots ? index : kMaxSlots - 1];
+    }
+    return *threadSlot;
+}
+
+void countAllocation(std::size_t size) {
+    ThreadAllocationSlot& slot = slotForThread();
+    slot.allocations[threadBucket].fetch_add(1, std::memory_order_relaxed);
+    slot.bytes[threadBucket].fetch_add(size, std::memory_order_relaxed);
+}
+#endif
+
+} // namespace
+
+std::size_t currentAllocationBucket() {
+    return threadBucket;
+}
+
+std::size_t exchangeAllocationBucket(std::size_t bucket) {
+    std::size_t previous = threadBucket;
+    threadBucket = bucket;
+    return previous;
+}
+
+AllocationReport collectAllocations() {
+    AllocationReport report;
+    std::size_t used = std::min(slotsUsed.load(std::memory_order_relaxed), kMaxSlots);
+    for (std::size_t i = 0; i < used; ++i) {
+        for (std::size_t bucket = 0; bucket < kAllocationBuckets; ++bucket) {
+            report.stages[bucket].allocations += slots[i].allocations[bucket].load(std::memory_order_relaxed);
+            report.stages[bucket].bytes += slots[i].bytes[bucket].load(std::memory_order_relaxed);
+        }
+    }
+    return report;
+}
+
+void resetAllocations() {
+    std::size_t used = std::min(slotsUsed.load(std::memory_order_relaxed), kMaxSlots);
+    for (std::size_t i = 0; i < used; ++i) {
+        for (std::size_t bucket = 0; bucket < kAllocationBuckets; ++bucket) {
+            slots[i].allocations[bucket].store(0, std::memory_order_relaxed);
+            slots[i].bytes[bucket].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::uint64_t peakResidentBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // В Linux ru_maxrss в килобайтах
+#endif
+}
+
+} // namespace expr
+
+#ifdef EXPR_ALLOC_TRACKING
+
+// Замена глобальных операторов выделения памяти: учет и обычный malloc/free.
+// Варианты с выравниванием используют aligned_alloc и free, а в Windows, где
+// aligned_alloc нет, — _aligned_malloc и парный ему _aligned_free.
+namespace {
+
+void* alignedAllocate(std::size_t align, std::size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    std::size_t rounded = (size + align - 1) / align * align; // aligned_alloc требует кратный размер
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void alignedFree(void* pointer) {
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void* trackedAllocate(std::size_t size) {
+    expr::countAllocation(size);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* trackedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    expr::countAllocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* pointer = alignedAllocate(align, size == 0 ? align : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return trackedAllocate(size); }
+void* operator new[](std::size_t size) { return trackedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return trackedAllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return trackedAllocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return trackedAllocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return trackedAllocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return trackedAllocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return trackedAllocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { alignedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { alignedFree(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { alignedFree(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { alignedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(pointer); }
+
+#endif
@@ -0,0 +1,288 @@
+#include "batch_mode.hpp"
+
+#include "console.hpp"
+#include "evaluator.hpp"
+#include "expression_processor.hpp"
+#include "input_source.hpp"
+#include "processing_options.hpp"
+#include "progress_bar.hpp"
+#include "result_writer.hpp"
+#include "thread_pool.hpp"
+#include "user_input.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Настройки запуска из командной строки
+struct BatchSettings {
+    std::filesystem::path inputPath = "-";  // "-" — стандартный ввод
+    std::filesystem::path outputPath = "-"; // "-" — стандартный вывод
+    std::size_t threadCount = 0;            // 0 — по числу ядер
+    bool quiet = false;                     // Только сообщения об ошибках
+    bool color = true;                      // Цветной вывод (если stderr — терминал)
+    bool help = false;
+    ProcessingOptions options;
+};
+
+// Справка по ключам
+void printUsage() {
+    std::cout <<
+        "Использование: expression_parser [ключи]\n"
+        "Без ключей программа работает в интерактивном режиме.\n\n"
+        "  -i, --input <файл>       входной файл, \"-\" — stdin (по умолчанию)\n"
+        "  -o, --output <файл>      файл результатов, \"-\" — stdout (по умолчанию)\n"
+        "  -t, --threads <N>        количество потоков (по умолчанию по числу ядер)\n"
+        "  -f, --format <формат>    csv (по умолчанию), columnar или ndjson\n"
+        "  -p, --profile <профиль>  full (по умолчанию), lean или errors\n"
+        "      --numbers <формат>   fixed10 (по умолчанию) или shortest\n"
+        "      --ranges             читать файл по диапазонам байт\n"
+        "  -q, --quiet              без прогресса и статистики\n"
+        "      --no-color           без цветового оформления\n"
+        "  -h, --help               эта справка\n\n"
+        "Коды завершения: 0 — ошибок нет, 1 — есть строки с ошибками,\n"
+        "2 — неверные аргументы или ошибка чтения и записи.\n";
+}
+
+// Разбор ключей командной строки; ключи вида --name=value и --name value равноправны
+BatchSettings parseArguments(int argc, char** argv) {
+    BatchSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        std::string value;
+        bool hasValue = false;
+        if (argument.rfind("--", 0) == 0 && argument.find('=') != std::string::npos) {
+            value = argument.substr(argument.find('=') + 1);
+            argument.erase(argument.find('='));
+            hasValue = true;
+        }
+
+        // Значение ключа: после '=' или следующим аргументом
+        auto takeValue = [&]() {
+            if (hasValue) {
+                return value;
+            }
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Не указано значение ключа " + argument);
+            }
+            return std::string(argv[++i]);
+        };
+
+        if (argument == "-i" || argument == "--input") {
+            settings.inputPath = takeValue();
+        }
+        else if (argument == "-o" || argument == "--output") {
+            settings.outputPath = takeValue();
+        }
+        else if (argument == "-t" || argument == "--threads") {
+            settings.threadCount = parseNumber(takeValue());
+        }
+        else if (argument == "-f" || argument == "--format") {
+            std::string format = takeValue();
+            if (format == "csv") {
+                settings.options.outputFormat = expr::OutputFormat::Csv;
+            }
+            else if (format == "columnar") {
+                settings.options.outputFormat = expr::OutputFormat::Columnar;
+            }
+            else if (format == "ndjson") {
+                settings.options.outputFormat = expr::OutputFormat::Ndjson;
+            }
+            else if (format == "slots") {
+                throw std::runtime_error("Позиционный формат доступен только в интерактивном режиме");
+            }
+            else {
+                throw std::runtime_error("Неизвестный формат результатов: " + format);
+            }
+        }
+        else if (argument == "-p" || argument == "--profile") {
+            std::string profile = takeValue();
+            if (profile == "full") {
+                settings.options.outputProfile = expr::OutputProfile::Full;
+            }
+            else if (profile == "lean") {
+                settings.options.outputProfile = expr::OutputProfile::Lean;
+            }
+            else if (profile == "errors") {
+                settings.options.outputProfile = expr::OutputProfile::ErrorsOnly;
+            }
+            else {
+                throw std::runtime_error("Неизвестный профиль вывода: " + profile);
+            }
+        }
+        else if (argument == "--numbers") {
+            std::string format = takeValue();
+            if (format == "fixed10") {
+                settings.options.numberFormat = expr::NumberFormat::Fixed10;
+            }
+            else if (format == "shortest") {
+                settings.options.numberFormat = expr::NumberFormat::Shortest;
+            }
+            else {
+                throw std::runtime_error("Неизвестный формат чисел: " + format);
+            }
+        }
+        else if (argument == "--ranges" && !hasValue) {
+            settings.options.readMode = ReadMode::ByteRanges;
+        }
+        else if ((argument == "-q" || argument == "--quiet") && !hasValue) {
+            settings.quiet = true;
+        }
+        else if (argument == "--no-color" && !hasValue) {
+            settings.color = false;
+        }
+        else if ((argument == "-h" || argument == "--help") && !hasValue) {
+            settings.help = true;
+        }
+        else {
+            throw std::runtime_error("Неизвестный ключ: " + argument + " (см. --help)");
+        }
+    }
+
+    // Справочник ошибок профиля lean в CSV пишется рядом с файлом результатов
+    if (settings.outputPath == "-" && settings.options.outputFormat == expr::OutputFormat::Csv
+        && settings.options.outputProfile == expr::OutputProfile::Lean) {
+        throw std::runtime_error("Профиль lean в формате CSV требует файл результатов, а не stdout");
+    }
+    return settings;
+}
+
+// Вывод в stderr идет на терминал (иначе цвет и прогресс только засоряют журнал)
+bool stderrIsTerminal() {
+#ifdef _WIN32
+    return false;
+#else
+    return isatty(STDERR_FILENO) != 0;
+#endif
+}
+
+// Обработка файла; возвращает код завершения
+int runBatch(const BatchSettings& settings) {
+    ProcessingOptions options = settings.options;
+    std::size_t threadCount = settings.threadCount;
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 2; // Резервное значение
+        }
+    }
+
+    // Поток ввода читается блоками, и прочитанные блоки освобождаются по мере записи
+    // результатов, поэтому память не растет с размером входа
+    expr::InputSource source(settings.inputPath);
+    if (options.readMode == ReadMode::ByteRanges && !source.isMapped()) {
+        if (!settings.quiet) {
+            std::cerr << Color::YELLOW << "Внимание: " << Color::RESET
+                << "вход нельзя отобразить в память, используется последовательный режим\n";
+        }
+        options.readMode = ReadMode::Sequential;
+    }
+    std::uint64_t totalBytes = source.isMapped() ? source.data().size() : 0;
+
+    std::chrono::high_resolution_clock::time_point startProcess = std::chrono::high_resolution_clock::now();
+
+    expr::ExpressionEvaluator evaluator;
+    ProgressState progress;
+    expr::ErrorCatalog errors;
+    expr::ThreadPool pool(threadCount); // После всего, на что ссылаются задачи: разрушается первым
+    std::unique_ptr<expr::ResultWriter> writer = expr::makeResultWriter(
+        options.outputFormat, settings.outputPath, errors, options.numberFormat, options.writeBuffers, options.outputProfile);
+
+    std::size_t errorCount = 0;
+    std::function<void(const std::vector<expr::EvaluationRecord>&)> processBatch = [&](const std::vector<expr::EvaluationRecord>& batch) {
+        for (const expr::EvaluationRecord& record : batch) {
+            if (!record.succeeded()) {
+                ++errorCount;
+            }
+            writer->writeRecord(record, source.text(record.offset, record.length));
+        }
+    };
+
+    // Прогресс рисуется только на терминале, в журнал пакетного запуска он не пишется
+    bool showProgress = !settings.quiet && stderrIsTerminal();
+    std::thread progressThread;
+    if (showProgress) {
+        progressThread = std::thread(displayProgress, std::cref(progress), totalBytes, std::size_t{ 0 }, std::ref(std::cerr));
+    }
+
+    std::size_t totalLines = 0;
+    try {
+        if (options.readMode == ReadMode::ByteRanges) {
+            totalLines = processExpressionsByRanges(source, evaluator, errors, nullptr, pool, progress, processBatch);
+        }
+        else {
+            totalLines = processExpressionsStreaming(source, evaluator, errors, nullptr, pool, progress, processBatch);
+        }
+    }
+    catch (...) {
+        // Останавливаем поток прогресса, иначе std::thread завершит программу
+        progress.finished = true;
+        if (progressThread.joinable()) {
+            progressThread.join();
+        }
+        throw;
+    }
+    progress.finished = true;
+    if (progressThread.joinable()) {
+        progressThread.join();
+    }
+
+    writer->close();
+
+    std::chrono::milliseconds processDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startProcess);
+
+    if (!settings.quiet) {
+        std::cerr << Color::BOLD << "Обработано выражений: " << Color::RESET << Color::CYAN << totalLines << Color::RESET
+            << ", успешно " << Color::GREEN << totalLines - errorCount << Color::RESET
+            << ", ошибок " << (errorCount > 0 ? Color::RED : Color::GREEN) << errorCount << Color::RESET
+            << ", " << Color::MAGENTA << processDuration.count() << " мс" << Color::RESET;
+        if (processDuration.count() > 0) {
+            std::cerr << " (" << static_cast<std::uint64_t>(totalLines * 1000.0 / processDuration.count()) << " выр/сек)";
+        }
+        std::cerr << "\n";
+    }
+
+    return errorCount > 0 ? kExitLineErrors : kExitSuccess;
+}
+
+} // namespace
+
+// Неинтерактивный режим: разбор ключей и обработка одного файла
+int runBatchMode(int argc, char** argv) {
+    // Цвет только для терминала; NO_COLOR — общепринятый способ отключить его явно
+    if (!stderrIsTerminal() || std::getenv("NO_COLOR") != nullptr) {
+        disableColors();
+    }
+
+    try {
+        BatchSettings settings = parseArguments(argc, argv);
+        if (!settings.color) {
+            disableColors();
+        }
+        if (settings.help) {
+            printUsage();
+            return kExitSuccess;
+        }
+        return runBatch(settings);
+    }
+    catch (const std::exception& ex) {
+        std::cerr << Color::RED << Color::BOLD << "✗ Ошибка: "
+            << Color::RESET << Color::RED << ex.what() << Color::RESET << "\n";
+        return kExitFailure;
+    }
+}
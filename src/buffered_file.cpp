@@ -0,0 +1,242 @@
+#include "buffered_file.hpp"
+
+#include "trace_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace expr {
+
+namespace {
+
+// Открытие файла результатов; "-" — стандартный вывод.
+// Для stdout берется копия дескриптора, чтобы close() не закрывал сам поток вывода.
+std::FILE* openOutput(const std::filesystem::path& path) {
+    if (path != "-") {
+        return std::fopen(path.string().c_str(), "wb");
+    }
+#ifdef _WIN32
+    return stdout;
+#else
+    std::fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0) {
+        return nullptr;
+    }
+    std::FILE* output = fdopen(fd, "wb");
+    if (output == nullptr) {
+        ::close(fd);
+    }
+    return output;
+#endif
+}
+
+} // namespace
+
+BufferedFile::BufferedFile(const std::filesystem::path& path, std::size_t bufferSize, std::size_t asyncBuffers) {
+    file = openOutput(path);
+    if (file == nullptr) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + path.string());
+    }
+    // Буферизацией занимаемся сами, буфер stdio дал бы лишнее копирование
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    active.data = std::make_unique<char[]>(bufferSize);
+    active.capacity = bufferSize;
+
+    // Один буфер нечего менять местами: асинхронная запись имеет смысл начиная с двух
+    if (asyncBuffers >= 2) {
+        async = true;
+        for (std::size_t i = 1; i < asyncBuffers; ++i) {
+            Chunk chunk;
+            chunk.data = std::make_unique<char[]>(bufferSize);
+            chunk.capacity = bufferSize;
+            freeChunks.push_back(std::move(chunk));
+        }
+        writerThread = std::thread([this]() { writerLoop(); });
+    }
+}
+
+BufferedFile::~BufferedFile() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Деструктор не должен выбрасывать исключения
+    }
+}
+
+void BufferedFile::append(std::string_view text) {
+    while (!text.empty()) {
+        if (active.size == active.capacity) {
+            flush();
+        }
+        // Большой кусок в синхронном режиме пишем напрямую, не дробя его через буфер
+        if (!async && active.size == 0 && text.size() >= active.capacity) {
+            writeDirect(text.data(), text.size());
+            return;
+        }
+        std::size_t part = std::min(text.size(), active.capacity - active.size);
+        std::memcpy(active.data.get() + active.size, text.data(), part);
+        active.size += part;
+        text.remove_prefix(part);
+    }
+}
+
+void BufferedFile::append(char ch) {
+    if (active.size == active.capacity) {
+        flush();
+    }
+    active.data[active.size++] = ch;
+}
+
+char* BufferedFile::reserve(std::size_t size) {
+    if (size > active.capacity - active.size) {
+        flush();
+        if (size > active.capacity) {
+            // Запрошено больше, чем весь буфер: увеличиваем его
+            active.data = std::make_unique<char[]>(size);
+            active.capacity = size;
+        }
+    }
+    return active.data.get() + active.size;
+}
+
+void BufferedFile::flush() {
+    if (active.size == 0) {
+        return;
+    }
+    if (async) {
+        submitActive();
+        return;
+    }
+    writeDirect(active.data.get(), active.size);
+    active.size = 0;
+}
+
+void BufferedFile::close() {
+    if (file == nullptr) {
+        return;
+    }
+
+    // Фоновый поток нужно остановить в любом случае, даже если запись не удалась
+    std::exception_ptr error;
+    try {
+        flush();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    if (writerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        writerThread.join();
+        if (!error) {
+            error = writeError;
+        }
+    }
+
+    std::FILE* closing = file;
+    file = nullptr;
+    if (std::fclose(closing) != 0 && !error) {
+        error = std::make_exception_ptr(std::runtime_error("Ошибка при закрытии выходного файла"));
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Одна системная запись с учетом времени и объема
+void BufferedFile::writeDirect(const char* data, std::size_t size) {
+    if (file == nullptr) {
+        throw std::runtime_error("Выходной файл уже закрыт");
+    }
+    TraceSpan span("запись на диск", size);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::size_t written = std::fwrite(data, 1, size, file);
+    writeStats.writeTime += std::chrono::steady_clock::now() - start;
+    if (written != size) {
+        throw std::runtime_error("Ошибка записи в выходной файл");
+    }
+    writeStats.bytesWritten += size;
+    flushedBytes.fetch_add(size, std::memory_order_relaxed);
+    ++writeStats.flushCount;
+}
+
+// Передача заполненного буфера фоновому потоку
+void BufferedFile::submitActive() {
+    std::unique_lock<std::mutex> lock(mutex);
+    rethrowWriteError();
+
+    filled.push_back(std::move(active));
+    writeStats.queueDepthSum += filled.size();
+    writeStats.maxQueueDepth = std::max(writeStats.maxQueueDepth, filled.size());
+    condition.notify_all();
+
+    // Все буферы заняты: диск не успевает, ждем освобождения
+    if (freeChunks.empty()) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        condition.wait(lock, [this]() { return !freeChunks.empty() || writeError; });
+        writeStats.stallTime += std::chrono::steady_clock::now() - start;
+        rethrowWriteError();
+    }
+
+    active = std::move(freeChunks.back());
+    freeChunks.pop_back();
+    active.size = 0;
+}
+
+// Фоновый поток: записывает буферы по очереди и возвращает их в список свободных
+void BufferedFile::writerLoop() {
+    if (tracingEnabled()) {
+        setTraceThreadName("фоновая запись");
+    }
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !filled.empty(); });
+            if (filled.empty()) {
+                return; // Остановка, и все буферы уже записаны
+            }
+            chunk = std::move(filled.front());
+            filled.pop_front();
+        }
+
+        // Запись идет без блокировки: вызывающий поток тем временем заполняет другой буфер
+        try {
+            writeDirect(chunk.data.get(), chunk.size);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            writeError = std::current_exception();
+            filled.clear();
+            condition.notify_all();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunk.size = 0;
+            freeChunks.push_back(std::move(chunk));
+        }
+        condition.notify_all();
+    }
+}
+
+void BufferedFile::rethrowWriteError() {
+    if (writeError) {
+        std::rethrow_exception(writeError);
+    }
+}
+
+} // namespace expr
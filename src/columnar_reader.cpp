@@ -0,0 +1,186 @@
+#include "columnar_reader.hpp"
+
+#include "buffered_file.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace expr {
+
+namespace {
+const std::string kNoError;
+
+// Проверка сигнатуры формата
+void checkMagic(const char* magic) {
+    if (std::memcmp(magic, kColumnarMagic, sizeof(kColumnarMagic)) != 0) {
+        throw std::runtime_error("Файл не является колоночным файлом результатов");
+    }
+}
+}
+
+ColumnarReader::ColumnarReader(const std::filesystem::path& path) : input(path, std::ios::binary) {
+    if (!input.is_open()) {
+        throw std::runtime_error("Не удалось открыть колоночный файл: " + path.string());
+    }
+
+    std::uint64_t fileSize = std::filesystem::file_size(path);
+    constexpr std::uint64_t headerSize = sizeof(kColumnarMagic) + 2 * sizeof(std::uint32_t);
+    constexpr std::uint64_t trailerSize = sizeof(std::uint64_t) + sizeof(kColumnarMagic);
+    if (fileSize < headerSize + trailerSize) {
+        throw std::runtime_error("Колоночный файл поврежден: слишком короткий");
+    }
+
+    // Заголовок
+    char magic[sizeof(kColumnarMagic)];
+    std::uint32_t version = 0;
+    readAt(0, magic, sizeof(magic));
+    checkMagic(magic);
+    readAt(sizeof(magic), &version, sizeof(version));
+    if (version != kColumnarVersion) {
+        throw std::runtime_error("Неподдерживаемая версия колоночного файла: " + std::to_string(version));
+    }
+
+    // Концовка указывает на подвал
+    std::uint64_t footerOffset = 0;
+    readAt(fileSize - trailerSize, &footerOffset, sizeof(footerOffset));
+    readAt(fileSize - sizeof(kColumnarMagic), magic, sizeof(magic));
+    checkMagic(magic);
+    if (footerOffset >= fileSize - trailerSize) {
+        throw std::runtime_error("Колоночный файл поврежден: неверное смещение подвала");
+    }
+
+    // Подвал читается последовательно. Счетчики из файла проверяются по оставшемуся
+    // размеру подвала до выделения памяти: в поврежденном файле там может быть что угодно.
+    input.clear();
+    input.seekg(static_cast<std::streamoff>(footerOffset));
+    std::uint64_t footerRemaining = fileSize - trailerSize - footerOffset;
+    auto read = [this, &footerRemaining](void* data, std::size_t size) {
+        if (size > footerRemaining || !input.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Колоночный файл поврежден: подвал обрезан");
+        }
+        footerRemaining -= size;
+    };
+    auto checkCount = [&footerRemaining](std::uint64_t count, std::uint64_t elementSize) {
+        if (count > footerRemaining / elementSize) {
+            throw std::runtime_error("Колоночный файл поврежден: счетчик в подвале больше размера файла");
+        }
+    };
+
+    std::uint32_t messageCount = 0;
+    read(&messageCount, sizeof(messageCount));
+    checkCount(messageCount, sizeof(std::uint32_t)); // У каждого сообщения есть хотя бы длина
+    messages.resize(messageCount);
+    for (std::string& message : messages) {
+        std::uint32_t length = 0;
+        read(&length, sizeof(length));
+        checkCount(length, 1);
+        message.resize(length);
+        read(message.data(), length);
+    }
+
+    std::uint64_t groupCount = 0;
+    read(&groupCount, sizeof(groupCount));
+    checkCount(groupCount, sizeof(ColumnarRowGroupIndex));
+    rowGroups.resize(static_cast<std::size_t>(groupCount));
+    for (ColumnarRowGroupIndex& index : rowGroups) {
+        read(&index, sizeof(index));
+        checkRowGroup(index, footerOffset);
+    }
+    read(&rowCount, sizeof(rowCount));
+}
+
+// Столбцы группы должны целиком лежать в области данных перед подвалом
+void ColumnarReader::checkRowGroup(const ColumnarRowGroupIndex& group, std::uint64_t dataEnd) {
+    auto fits = [dataEnd](std::uint64_t offset, std::uint64_t size) {
+        return offset <= dataEnd && size <= dataEnd - offset;
+    };
+    std::uint64_t rows = group.rowCount;
+    if (rows > dataEnd / sizeof(std::uint64_t)
+        || !fits(group.lineNumbersOffset, rows * sizeof(std::uint64_t))
+        || !fits(group.valuesOffset, rows * sizeof(double))
+        || !fits(group.validityOffset, (rows + 7) / 8)
+        || !fits(group.errorCodesOffset, rows * sizeof(std::uint32_t))) {
+        throw std::runtime_error("Колоночный файл поврежден: группа строк за пределами файла");
+    }
+}
+
+ColumnarRowGroup ColumnarReader::readRowGroup(std::size_t index) {
+    if (index >= rowGroups.size()) {
+        throw std::out_of_range("Номер группы строк вне диапазона");
+    }
+    const ColumnarRowGroupIndex& group = rowGroups[index];
+    std::size_t rows = static_cast<std::size_t>(group.rowCount);
+
+    ColumnarRowGroup result;
+    result.lineNumbers.resize(rows);
+    result.values.resize(rows);
+    result.validity.resize((rows + 7) / 8);
+    result.errorCodes.resize(rows);
+
+    readAt(group.lineNumbersOffset, result.lineNumbers.data(), rows * sizeof(std::uint64_t));
+    readAt(group.valuesOffset, result.values.data(), rows * sizeof(double));
+    readAt(group.validityOffset, result.validity.data(), result.validity.size());
+    readAt(group.errorCodesOffset, result.errorCodes.data(), rows * sizeof(std::uint32_t));
+
+    for (std::uint32_t code : result.errorCodes) {
+        if (code > messages.size()) {
+            throw std::runtime_error("Колоночный файл поврежден: неизвестный код ошибки");
+        }
+    }
+    return result;
+}
+
+const std::string& ColumnarReader::errorMessage(std::uint32_t code) const {
+    if (code == 0) {
+        return kNoError;
+    }
+    return messages.at(code - 1);
+}
+
+void ColumnarReader::readAt(std::uint64_t offset, void* data, std::size_t size) {
+    input.clear();
+    input.seekg(static_cast<std::streamoff>(offset));
+    if (!input.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Колоночный файл поврежден: данные обрезаны");
+    }
+}
+
+// Преобразование колоночного файла в CSV
+std::uint64_t convertColumnarToCsv(const std::filesystem::path& inputPath,
+    const std::filesystem::path& outputPath,
+    NumberFormat numberFormat) {
+    ColumnarReader reader(inputPath);
+    BufferedFile output(outputPath);
+    output.append("line,status,result,message\n");
+
+    for (std::size_t group = 0; group < reader.rowGroupCount(); ++group) {
+        ColumnarRowGroup columns = reader.readRowGroup(group);
+        for (std::size_t row = 0; row < columns.lineNumbers.size(); ++row) {
+            char* lineText = output.reserve(32);
+            std::to_chars_result lineEnd = std::to_chars(lineText, lineText + 32, columns.lineNumbers[row]);
+            output.commit(static_cast<std::size_t>(lineEnd.ptr - lineText));
+
+            std::uint32_t code = columns.errorCodes[row];
+            output.append(code == 0 ? ",success," : ",error,");
+
+            if (columns.hasValue(row)) {
+                char* number = output.reserve(kMaxFormattedNumberLength);
+                char* numberEnd = formatNumber(number, columns.values[row], numberFormat);
+                output.commit(static_cast<std::size_t>(numberEnd - number));
+            }
+
+            // Сообщения экранируются так же, как в CsvWriter: двойные кавычки заменяются одинарными
+            output.append(",\"");
+            for (char ch : reader.errorMessage(code)) {
+                output.append(ch == '"' ? '\'' : ch);
+            }
+            output.append("\"\n");
+        }
+    }
+
+    output.close();
+    return reader.totalRows();
+}
+
+} // namespace expr
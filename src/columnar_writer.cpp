@@ -0,0 +1,128 @@
+#include "columnar_writer.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace expr {
+
+static_assert(std::endian::native == std::endian::little,
+    "Колоночный формат записывается в little-endian, другой порядок байт не поддерживается");
+
+ColumnarWriter::ColumnarWriter(const std::filesystem::path& path, const ErrorCatalog& errors, std::size_t asyncBuffers, std::size_t rowGroupSize, bool errorsOnly)
+    : ResultWriter(errors), file(path, BufferedFile::kDefaultBufferSize, asyncBuffers),
+      rowGroupSize(rowGroupSize == 0 ? kDefaultRowGroupSize : rowGroupSize),
+      errorsOnly(errorsOnly) {
+    lineNumbers.reserve(this->rowGroupSize);
+    values.reserve(this->rowGroupSize);
+    validity.reserve((this->rowGroupSize + 7) / 8);
+    errorCodes.reserve(this->rowGroupSize);
+
+    // Заголовок
+    writeBytes(kColumnarMagic, sizeof(kColumnarMagic));
+    writeValue<std::uint32_t>(kColumnarVersion);
+    writeValue<std::uint32_t>(0);
+}
+
+// Добавление результата в столбцы текущей группы
+// Текст выражения в колоночный формат не попадает
+void ColumnarWriter::writeRecord(const EvaluationRecord& record, std::string_view /*expression*/) {
+    if (errorsOnly && record.succeeded()) {
+        return;
+    }
+
+    std::size_t row = lineNumbers.size();
+    if (row % 8 == 0) {
+        validity.push_back(0);
+    }
+
+    lineNumbers.push_back(record.lineNumber);
+    values.push_back(record.succeeded() ? record.value : 0.0);
+    if (record.succeeded()) {
+        validity.back() |= static_cast<std::uint8_t>(1u << (row % 8));
+    }
+
+    // Коды ошибок справочника записываются как есть, тексты — один раз в подвале
+    errorCodes.push_back(record.errorCode);
+
+    ++recordCount;
+    if (lineNumbers.size() >= rowGroupSize) {
+        writeRowGroup();
+    }
+}
+
+// Запись группы строк столбец за столбцом
+void ColumnarWriter::writeRowGroup() {
+    if (lineNumbers.empty()) {
+        return;
+    }
+
+    ColumnarRowGroupIndex index{};
+    index.rowCount = lineNumbers.size();
+
+    index.lineNumbersOffset = offset;
+    writeBytes(lineNumbers.data(), lineNumbers.size() * sizeof(std::uint64_t));
+
+    index.valuesOffset = offset;
+    writeBytes(values.data(), values.size() * sizeof(double));
+
+    index.validityOffset = offset;
+    writeBytes(validity.data(), validity.size());
+
+    // Выравнивание, чтобы коды ошибок (и следующая группа) начинались с границы 8 байт
+    static const char padding[8] = {};
+    writeBytes(padding, static_cast<std::size_t>((8 - offset % 8) % 8));
+
+    index.errorCodesOffset = offset;
+    writeBytes(errorCodes.data(), errorCodes.size() * sizeof(std::uint32_t));
+    writeBytes(padding, static_cast<std::size_t>((8 - offset % 8) % 8));
+
+    rowGroups.push_back(index);
+
+    lineNumbers.clear();
+    values.clear();
+    validity.clear();
+    errorCodes.clear();
+}
+
+void ColumnarWriter::flush() {
+    writeRowGroup();
+    file.flush();
+}
+
+// Последняя группа, подвал со словарем и индексом, концовка
+void ColumnarWriter::close() {
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    writeRowGroup();
+
+    // Словарь — все сообщения справочника в порядке кодов (код 1 — первое)
+    std::uint64_t footerOffset = offset;
+    std::uint32_t messageCount = static_cast<std::uint32_t>(errors.size());
+    writeValue<std::uint32_t>(messageCount);
+    for (std::uint32_t code = 1; code <= messageCount; ++code) {
+        std::string_view message = errors.message(code);
+        writeValue<std::uint32_t>(static_cast<std::uint32_t>(message.size()));
+        writeBytes(message.data(), message.size());
+    }
+
+    writeValue<std::uint64_t>(rowGroups.size());
+    for (const ColumnarRowGroupIndex& index : rowGroups) {
+        writeValue(index);
+    }
+    writeValue<std::uint64_t>(recordCount);
+
+    writeValue<std::uint64_t>(footerOffset);
+    writeBytes(kColumnarMagic, sizeof(kColumnarMagic));
+
+    file.close();
+}
+
+void ColumnarWriter::writeBytes(const void* data, std::size_t size) {
+    file.append(std::string_view(static_cast<const char*>(data), size));
+    offset += size;
+}
+
+} // namespace expr
@@ -1,5 +1,24 @@
 #include "console.hpp"
 
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <string_view>
+
+// Отключение цветового оформления вывода
+void disableColors() {
+    for (const char** code : { &Color::RESET, &Color::BOLD, &Color::RED, &Color::GREEN, &Color::YELLOW,
+             &Color::BLUE, &Color::MAGENTA, &Color::CYAN, &Color::GRAY }) {
+        *code = "";
+    }
+}
+
+// Ширина текста в символах: байты продолжения UTF-8 (10xxxxxx) не считаются
+std::size_t displayWidth(std::string_view text) {
+    return static_cast<std::size_t>(std::count_if(text.begin(), text.end(),
+        [](char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; }));
+}
+
 // Вывод приветственного заголовка программы
 void printHeader() {
     std::cout << Color::BOLD << Color::CYAN;
@@ -9,3 +28,44 @@ void printHeader() {
     std::cout << Color::RESET << "\n";
 }
 
+
+// Вывод времени по этапам обработки: сумма по потокам, количество и перцентили
+void printStageTimings(const expr::StageTimings& timings) {
+    auto micros = [](std::uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+
+    std::cout << Color::BOLD << "Этапы (сумма по потокам, p50/p99/p99.9 в мкс):\n" << Color::RESET;
+    for (std::size_t i = 0; i < expr::kStageCount; ++i) {
+        expr::Stage stage = static_cast<expr::Stage>(i);
+        const expr::LatencyHistogram& histogram = timings[stage];
+        std::string_view name = expr::stageName(stage);
+        std::size_t width = displayWidth(name);
+        std::cout << "  " << name << std::string(width < 14 ? 14 - width : 1, ' ') << Color::MAGENTA;
+        if (histogram.count() == 0) {
+            std::cout << "нет замеров" << Color::RESET << "\n";
+            continue;
+        }
+        std::cout << histogram.totalNanoseconds() / 1000000 << " мс, " << histogram.count() << " раз, "
+            << std::fixed << std::setprecision(1)
+            << micros(histogram.percentile(0.5)) << " / " << micros(histogram.percentile(0.99)) << " / "
+            << micros(histogram.percentile(0.999)) << Color::RESET << "\n";
+    }
+}
+
+// Вывод выделений памяти по этапам на одно выражение и пикового объема памяти
+void printAllocationReport(const expr::AllocationReport& report, std::uint64_t expressions) {
+    std::cout << Color::BOLD << "Выделения памяти (на выражение):\n" << Color::RESET;
+    double divisor = expressions > 0 ? static_cast<double>(expressions) : 1.0;
+    for (std::size_t bucket = 0; bucket < expr::kAllocationBuckets; ++bucket) {
+        std::string_view name = bucket == expr::kOtherAllocations
+            ? std::string_view("прочее") : std::string_view(expr::stageName(static_cast<expr::Stage>(bucket)));
+        std::size_t width = displayWidth(name);
+        const expr::AllocationCounts& counts = report.stages[bucket];
+        std::cout << "  " << name << std::string(width < 14 ? 14 - width : 1, ' ') << Color::MAGENTA
+            << std::fixed << std::setprecision(2) << counts.allocations / divisor << " выделений, "
+            << counts.bytes / divisor << " байт" << Color::RESET
+            << Color::GRAY << " (всего " << counts.allocations << ", " << counts.bytes / (1024 * 1024) << " МБ)"
+            << Color::RESET << "\n";
+    }
+    std::cout << "  Пик памяти:   " << Color::MAGENTA << expr::peakResidentBytes() / (1024 * 1024) << " МБ"
+        << Color::RESET << "\n";
+}
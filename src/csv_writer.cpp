@@ -1,111 +1,141 @@
 #include "csv_writer.hpp"
 
-#include <iomanip>
-#include <sstream>
+#include <charconv>
 #include <stdexcept>
 
 namespace expr {
 
-CsvWriter::CsvWriter(std::filesystem::path targetPath) : path(std::move(targetPath)) {
+namespace {
+
+// Запись текста с заменой двойных кавычек на одинарные.
+// Текст копируется в буфер кусками между кавычками, без временной строки.
+void appendSanitized(BufferedFile& file, std::string_view text) {
+    std::size_t start = 0;
+    while (true) {
+        std::size_t quote = text.find('"', start);
+        if (quote == std::string_view::npos) {
+            file.append(text.substr(start));
+            return;
+        }
+        file.append(text.substr(start, quote - start));
+        file.append('\'');
+        start = quote + 1;
+    }
+}
+
+} // namespace
+
+CsvWriter::CsvWriter(std::filesystem::path targetPath, const ErrorCatalog& errors, NumberFormat format,
+    std::size_t asyncBuffers, OutputProfile profile)
+    : ResultWriter(errors), path(std::move(targetPath)), file(path, BufferedFile::kDefaultBufferSize, asyncBuffers),
+      numberFormat(format), profile(profile) {
     initialize();
 }
 
-// Инициализация файла (запись заголовка)
-void CsvWriter::initialize() const {
-    std::ofstream stream(path, std::ios::trunc);
-    if (!stream.is_open()) {
-        throw std::runtime_error("Не удалось открыть файл для записи CSV");
+// Инициализация файла (запись заголовка выбранного профиля)
+void CsvWriter::initialize() {
+    switch (profile) {
+    case OutputProfile::Lean:
+        file.append("line,status,result,error_code\n");
+        break;
+    case OutputProfile::ErrorsOnly:
+        file.append("line,expression,message\n");
+        break;
+    case OutputProfile::Full:
+    default:
+        file.append("line,expression,status,result,message\n");
+        break;
     }
-    stream << "line,expression,status,result,message\n";
-    headerWritten = true;
 }
 
-// Запись одного результата в файл (для потоковой записи)
-void CsvWriter::writeRecord(const EvaluationRecord& record) const {
-    std::ofstream stream(path, std::ios::app);
-    if (!stream.is_open()) {
-        throw std::runtime_error("Не удалось открыть файл для записи CSV");
+// Запись целого числа без промежуточной строки
+void CsvWriter::writeInteger(std::uint64_t value) {
+    char* text = file.reserve(32);
+    std::to_chars_result end = std::to_chars(text, text + 32, value);
+    file.commit(static_cast<std::size_t>(end.ptr - text));
+}
+
+// Запись одного результата в буфер (для потоковой записи).
+// Текст выражения и сообщение об ошибке подставляются только здесь.
+void CsvWriter::writeRecord(const EvaluationRecord& record, std::string_view expression) {
+    if (profile == OutputProfile::ErrorsOnly) {
+        if (record.succeeded()) {
+            return;
+        }
+        writeInteger(record.lineNumber);
+        file.append(",\"");
+        appendSanitized(file, expression);
+        file.append("\",\"");
+        appendSanitized(file, errors.message(record.errorCode));
+        file.append("\"\n");
+        ++recordCount;
+        return;
     }
-    
-    // Настройка формата вывода чисел
-    stream.setf(std::ios::fixed);
-    stream << std::setprecision(10);
 
-    stream << record.lineNumber << ',';
+    writeInteger(record.lineNumber);
+    file.append(',');
 
     // Экранирование выражения (замена двойных кавычек на одинарные)
     // и оборачивание в кавычки
-    std::string sanitized = record.expression;
-    for (char& ch : sanitized) {
-        if (ch == '"') {
-            ch = '\'';
-        }
+    if (profile == OutputProfile::Full) {
+        file.append('"');
+        appendSanitized(file, expression);
+        file.append("\",");
     }
-    stream << '"' << sanitized << '"' << ',';
 
-    stream << record.status << ',';
+    file.append(statusName(record.status()));
+    file.append(',');
     
-    // Запись числового значения, если оно есть
-    if (record.value.has_value()) {
-        stream << record.value.value();
+    // Запись числового значения, если оно есть, прямо в буфер файла
+    if (record.succeeded()) {
+        char* number = file.reserve(kMaxFormattedNumberLength);
+        char* numberEnd = formatNumber(number, record.value, numberFormat);
+        file.commit(static_cast<std::size_t>(numberEnd - number));
     }
-    stream << ',';
+    file.append(',');
 
-    // Экранирование сообщения об ошибке
-    std::string message = record.message;
-    for (char& ch : message) {
-        if (ch == '"') {
-            ch = '\'';
-        }
+    if (profile == OutputProfile::Lean) {
+        // Вместо текста ошибки — ее код (0 при успехе)
+        writeInteger(record.errorCode);
+        file.append('\n');
     }
-    stream << '"' << message << '"' << '\n';
+    else {
+        // Экранирование сообщения об ошибке
+        file.append('"');
+        appendSanitized(file, errors.message(record.errorCode));
+        file.append("\"\n");
+    }
+
+    ++recordCount;
 }
 
-// Запись результатов в CSV файл
-// Формат: line,expression,status,result,message
-void CsvWriter::write(const std::vector<EvaluationRecord>& records) const {
-    if (!headerWritten) {
-        initialize();
-    }
-    
-    std::ofstream stream(path, std::ios::app);
-    if (!stream.is_open()) {
-        throw std::runtime_error("Не удалось открыть файл для записи CSV");
+// Справочник кодов ошибок рядом с файлом результатов: <имя>_errors.csv
+void CsvWriter::writeErrorDictionary() {
+    std::filesystem::path dictionaryPath = path;
+    dictionaryPath.replace_filename(path.stem().string() + "_errors.csv");
+
+    BufferedFile dictionary(dictionaryPath);
+    dictionary.append("error_code,message\n");
+    for (std::uint32_t code = 1; code <= static_cast<std::uint32_t>(errors.size()); ++code) {
+        char* text = dictionary.reserve(16);
+        std::to_chars_result end = std::to_chars(text, text + 16, code);
+        dictionary.commit(static_cast<std::size_t>(end.ptr - text));
+        dictionary.append(",\"");
+        appendSanitized(dictionary, errors.message(code));
+        dictionary.append("\"\n");
     }
-    
-    // Настройка формата вывода чисел
-    stream.setf(std::ios::fixed);
-    stream << std::setprecision(10);
-
-    for (const auto& record : records) {
-        stream << record.lineNumber << ',';
-
-        // Экранирование выражения (замена двойных кавычек на одинарные)
-        // и оборачивание в кавычки
-        std::string sanitized = record.expression;
-        for (char& ch : sanitized) {
-            if (ch == '"') {
-                ch = '\'';
-            }
-        }
-        stream << '"' << sanitized << '"' << ',';
+    dictionary.close();
+}
 
-        stream << record.status << ',';
-        
-        // Запись числового значения, если оно есть
-        if (record.value.has_value()) {
-            stream << record.value.value();
-        }
-        stream << ',';
+void CsvWriter::flush() {
+    file.flush();
+}
 
-        // Экранирование сообщения об ошибке
-        std::string message = record.message;
-        for (char& ch : message) {
-            if (ch == '"') {
-                ch = '\'';
-            }
-        }
-        stream << '"' << message << '"' << '\n';
+void CsvWriter::close() {
+    file.close();
+    if (profile == OutputProfile::Lean && !dictionaryWritten) {
+        dictionaryWritten = true;
+        writeErrorDictionary();
     }
 }
 
@@ -0,0 +1,46 @@
+#include "error_catalog.hpp"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace expr {
+
+// Поиск под разделяемой блокировкой, добавление под эксклюзивной
+std::uint32_t ErrorCatalog::intern(std::string_view message) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto found = codes.find(message);
+        if (found != codes.end()) {
+            return found->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    // Пока блокировка была снята, сообщение мог добавить другой поток
+    auto found = codes.find(message);
+    if (found != codes.end()) {
+        return found->second;
+    }
+    messages.emplace_back(message);
+    std::uint32_t code = static_cast<std::uint32_t>(messages.size());
+    codes.emplace(messages.back(), code);
+    return code;
+}
+
+std::string_view ErrorCatalog::message(std::uint32_t code) const {
+    if (code == kNoError) {
+        return {};
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (code > messages.size()) {
+        throw std::out_of_range("Неизвестный код ошибки");
+    }
+    return messages[code - 1];
+}
+
+std::size_t ErrorCatalog::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return messages.size();
+}
+
+} // namespace expr
@@ -1,6 +1,8 @@
 #include "evaluator.hpp"
 
+#include "alloc_tracking.hpp"
 #include "parser.hpp"
+#include "stage_timing.hpp"
 #include "tokenizer.hpp"
 
 namespace expr {
@@ -9,17 +11,29 @@ namespace expr {
 // 1. Токенизация (Tokenizer)
 // 2. Парсинг (Parser) -> построение AST
 // 3. Вычисление (evaluate) -> получение числового результата
-double ExpressionEvaluator::evaluate(const std::string& expression) const {
+// Время каждого этапа учитывается только для выражений, прошедших этап без ошибки.
+double ExpressionEvaluator::evaluate(std::string_view expression) const {
+    AllocationStageScope allocationStage(Stage::Tokenize);
+
     // Этап 1: Лексический анализ
+    StageClock::time_point start = stageTimestamp();
     Tokenizer tokenizer(expression);
     std::vector<Token> tokens = tokenizer.tokenize();
+    recordStageSince(Stage::Tokenize, start);
 
     // Этап 2: Синтаксический анализ
+    allocationStage.switchTo(Stage::Parse);
+    start = stageTimestamp();
     Parser parser(std::move(tokens));
     std::unique_ptr<AstNode> ast = parser.parse();
+    recordStageSince(Stage::Parse, start);
 
     // Этап 3: Вычисление
-    return ast->evaluate();
+    allocationStage.switchTo(Stage::Evaluate);
+    start = stageTimestamp();
+    double value = ast->evaluate();
+    recordStageSince(Stage::Evaluate, start);
+    return value;
 }
 
 } // namespace expr
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cctype>
 #include <chrono>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -14,53 +15,67 @@
 #include <ctime>
 #endif
 
-// Быстрый подсчет количества строк в файле
-// Читает файл блоками и считает символы новой строки
-std::size_t countLinesInFile(const std::filesystem::path& path) {
-    std::ifstream input(path, std::ios::binary);
-    if (!input.is_open()) {
-        throw std::runtime_error("Не удалось открыть файл для подсчета строк");
+// Подсчет символов новой строки в блоке памяти.
+// memchr в стандартной библиотеке векторизован (SSE2/AVX2), поэтому
+// перескакивать между переводами строк им намного быстрее побайтового цикла.
+std::size_t countNewlines(std::string_view data) {
+    std::size_t count = 0;
+    const char* current = data.data();
+    const char* end = data.data() + data.size();
+    while (current < end) {
+        const void* found = std::memchr(current, '\n', static_cast<std::size_t>(end - current));
+        if (found == nullptr) {
+            break;
+        }
+        ++count;
+        current = static_cast<const char*>(found) + 1;
     }
+    return count;
+}
 
-    // Увеличиваем размер буфера для быстрого чтения
-    constexpr std::size_t bufferSize = 4 * 1024 * 1024;  // 4 МБ буфер
-    char* fileBuffer = new char[bufferSize];
-    input.rdbuf()->pubsetbuf(fileBuffer, bufferSize);
+// Подсчет строк в данных (последняя строка может не заканчиваться '\n')
+std::size_t countLines(std::string_view data) {
+    std::size_t lineCount = countNewlines(data);
+    if (!data.empty() && data.back() != '\n') {
+        ++lineCount; // Последняя строка без \n
+    }
+    return lineCount;
+}
 
-    std::size_t lineCount = 0;
-    bool hasContent = false;
+// Разбиение данных на диапазоны, выровненные по границам строк
+std::vector<ByteRange> splitIntoLineRanges(std::string_view data, std::size_t rangeCount) {
+    std::vector<ByteRange> ranges;
+    if (data.empty()) {
+        return ranges;
+    }
+    if (rangeCount == 0) {
+        rangeCount = 1;
+    }
 
-    // Выделяем буфер динамически, чтобы избежать переполнения стека
-    std::vector<char> readBuffer(bufferSize);
+    std::uint64_t size = data.size();
+    std::uint64_t begin = 0;
 
-    while (input.read(readBuffer.data(), bufferSize) || input.gcount() > 0) {
-        std::size_t bytesRead = input.gcount();
-        if (bytesRead > 0) {
-            hasContent = true;
-            for (std::size_t i = 0; i < bytesRead; ++i) {
-                if (readBuffer[i] == '\n') {
-                    ++lineCount;
-                }
-            }
+    for (std::size_t i = 1; i < rangeCount; ++i) {
+        std::uint64_t target = size * i / rangeCount;
+        if (target <= begin) {
+            continue; // Предыдущий диапазон уже захватил эту точку (очень длинная строка)
         }
-    }
 
-    // Если файл не пустой и не заканчивается на \n, считаем последнюю строку
-    if (hasContent) {
-        input.clear();
-        input.seekg(0, std::ios::end);
-        std::streampos fileSize = input.tellg();
-        if (fileSize > 0) {
-            input.seekg(-1, std::ios::end);
-            char lastChar;
-            if (input.get(lastChar) && lastChar != '\n') {
-                ++lineCount;  // Последняя строка без \n
-            }
+        // Ищем ближайший перевод строки начиная с target: новый диапазон начнется сразу после него
+        const void* found = std::memchr(data.data() + target, '\n', static_cast<std::size_t>(size - target));
+        if (found == nullptr) {
+            break;
+        }
+        std::uint64_t boundary = static_cast<std::uint64_t>(static_cast<const char*>(found) - data.data()) + 1;
+        if (boundary >= size) {
+            break;
         }
+        ranges.push_back({ begin, boundary });
+        begin = boundary;
     }
 
-    delete[] fileBuffer;
-    return lineCount;
+    ranges.push_back({ begin, size });
+    return ranges;
 }
 
 // Поиск корневой директории проекта (ищет папку tests или файл CMakeLists.txt)
@@ -1,14 +1,43 @@
 #include "generate_mode.hpp"
+#include "buffered_file.hpp"
 #include "console.hpp"
 #include "file_utils.hpp"
+#include "random_streams.hpp"
+#include "thread_pool.hpp"
 #include "user_input.hpp"
-#include "expression_generator.hpp"
+#include "fast_expression_generator.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <filesystem>
-#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
-#include <vector>
+#include <string>
+
+namespace {
+
+// Выражений в одном блоке. Блок — единица работы потока и единица детерминизма:
+// у каждого блока свой генератор с зерном, выведенным из общего зерна по номеру блока,
+// поэтому содержимое файла не зависит от числа потоков.
+constexpr std::size_t kGenerateBlockSize = 65536;
+
+// Генерирует блок выражений [first, first + count) в одну строку, по выражению на строку.
+// Выражения дописываются прямо в буфер блока, без промежуточных строк.
+std::string generateBlock(const GeneratorProfile& profile, std::uint64_t seed, std::size_t blockIndex,
+    std::size_t first, std::size_t count) {
+    FastExpressionGenerator generator(deriveStreamSeed(seed, blockIndex), profile);
+    std::string text;
+    text.reserve(count * 96);
+    for (std::size_t i = first; i < first + count; ++i) {
+        generator.generateLine(text, i);
+        text.push_back('\n');
+    }
+    return text;
+}
+
+} // namespace
 
 // Режим генерации выражений
 void runGenerateMode() {
@@ -23,7 +52,14 @@ void runGenerateMode() {
         // 2. Получаем имя файла
         std::filesystem::path fileName = selectGeneratedFileName(expressionCount);
 
-        // 3. Определяем путь к папке tests
+        // 3. Зерно и число потоков: одно зерно дает один и тот же файл при любом числе потоков
+        std::uint64_t seed = askGeneratorSeed();
+        std::size_t threadCount = selectThreadCount();
+
+        // 4. Профиль нагрузки: встроенный или из файла параметров
+        GeneratorProfile profile = selectGeneratorProfile();
+
+        // 5. Определяем путь к папке tests
         std::filesystem::path projectDir = findProjectRoot();
         std::filesystem::path testsDir = projectDir / "tests";
 
@@ -37,65 +73,60 @@ void runGenerateMode() {
         std::cout << "\n";
         std::cout << Color::BOLD << "Конфигурация:\n" << Color::RESET;
         std::cout << "  Количество выражений: " << Color::CYAN << expressionCount << Color::RESET << "\n";
+        std::cout << "  Зерно:                " << Color::CYAN << seed << Color::RESET << "\n";
+        std::cout << "  Профиль нагрузки:     " << Color::CYAN << profile.name << Color::RESET << "\n";
+        std::cout << "  Потоков:              " << Color::CYAN << threadCount << Color::RESET << "\n";
         std::cout << "  Выходной файл:        " << Color::YELLOW << outputPath << Color::RESET << "\n\n";
 
-        // 4. Генерируем выражения
+        // 6. Генерируем выражения: потоки генерируют блоки, блоки пишутся в файл строго по порядку
         std::cout << Color::BOLD << "Генерация выражений..." << Color::RESET << std::flush;
         std::chrono::high_resolution_clock::time_point startGen = std::chrono::high_resolution_clock::now();
 
-        ExpressionGenerator generator;
-        std::ofstream output(outputPath);
-        if (!output.is_open()) {
-            throw std::runtime_error("Не удалось создать файл: " + outputPath.string());
-        }
-
-        // Увеличиваем размер буфера для записи (1 МБ) для ускорения
-        constexpr std::size_t bufferSize = 1024 * 1024;
-        char* fileBuffer = new char[bufferSize];
-        output.rdbuf()->pubsetbuf(fileBuffer, bufferSize);
-
-        // Буферизация вывода: собираем строки в буфер и записываем батчами
-        constexpr std::size_t batchSize = 10000;
-        std::vector<std::string> buffer;
-        buffer.reserve(batchSize);
-
-        for (std::size_t i = 0; i < expressionCount; ++i) {
-            // Генерируем выражения с глубиной от 4 до 8 для более длинных выражений
-            int depth = 4 + (i % 5);
-            buffer.emplace_back(generator.generate(depth));
-
-            // Когда буфер заполнен, записываем батч в файл
-            if (buffer.size() >= batchSize) {
-                for (const auto& expr : buffer) {
-                    output << expr << "\n";
-                }
-                buffer.clear();
-                buffer.reserve(batchSize);
+        expr::BufferedFile output(outputPath);
+        expr::ThreadPool pool(threadCount);
+
+        // Одновременно в работе не больше двух блоков на поток, чтобы не держать в памяти весь файл
+        const std::size_t maxInFlight = pool.size() * 2;
+        const std::size_t blockCount = (expressionCount + kGenerateBlockSize - 1) / kGenerateBlockSize;
+        std::deque<std::future<std::string>> inFlight;
+        std::size_t nextBlock = 0;
+        std::size_t written = 0;
+
+        while (nextBlock < blockCount || !inFlight.empty()) {
+            while (nextBlock < blockCount && inFlight.size() < maxInFlight) {
+                std::size_t first = nextBlock * kGenerateBlockSize;
+                std::size_t count = std::min(kGenerateBlockSize, expressionCount - first);
+                inFlight.emplace_back(pool.enqueue(generateBlock, std::cref(profile), seed, nextBlock, first, count));
+                ++nextBlock;
             }
 
-            // Показываем прогресс для больших файлов
-            if ((i + 1) % 10000 == 0) {
-                std::cout << "\r  " << Color::CYAN << (i + 1) << "/" << expressionCount
-                    << " выражений сгенерировано..." << Color::RESET << std::flush;
-            }
-        }
+            // Записываем самый ранний блок
+            std::string block = inFlight.front().get();
+            inFlight.pop_front();
+            output.append(block);
+            written = std::min(written + kGenerateBlockSize, expressionCount);
 
-        // Записываем оставшиеся выражения
-        if (!buffer.empty()) {
-            for (const auto& expr : buffer) {
-                output << expr << "\n";
-            }
+            // Показываем прогресс для больших файлов
+            std::cout << "\r  " << Color::CYAN << written << "/" << expressionCount
+                << " выражений сгенерировано..." << Color::RESET << std::flush;
         }
 
         output.close();
-        delete[] fileBuffer;
 
         std::chrono::high_resolution_clock::time_point endGen = std::chrono::high_resolution_clock::now();
         std::chrono::milliseconds genDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endGen - startGen);
 
+        // Скорость генерации в байтах: выражения разной длины, поэтому число выражений в секунду мало о чем говорит
+        std::uint64_t bytesGenerated = output.stats().bytesWritten;
         std::cout << "\r  " << Color::GREEN << "✓" << Color::RESET << " ("
             << expressionCount << " выражений, "
-            << genDuration.count() << " мс)\n\n";
+            << bytesGenerated / (1024 * 1024) << " МБ, "
+            << genDuration.count() << " мс";
+        if (genDuration.count() > 0) {
+            std::cout << ", " << static_cast<std::uint64_t>(bytesGenerated / (1024.0 * 1024.0) * 1000.0 / genDuration.count())
+                << " МБ/с";
+        }
+        std::cout << ")\n\n";
 
         std::cout << Color::GREEN << "Файл успешно создан: " << outputPath << Color::RESET << "\n\n";
 
@@ -106,4 +137,3 @@ void runGenerateMode() {
         throw;
     }
 }
-
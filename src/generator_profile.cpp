@@ -0,0 +1,220 @@
+#include "generator_profile.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Удаление пробелов по краям
+std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Ключи файла параметров и поля профиля, в которые они записываются
+using Setter = std::function<void(GeneratorProfile&, double)>;
+
+const std::unordered_map<std::string, Setter>& profileKeys() {
+    static const std::unordered_map<std::string, Setter> keys = {
+        { "min_depth", [](GeneratorProfile& p, double v) { p.minDepth = static_cast<int>(v); } },
+        { "max_depth", [](GeneratorProfile& p, double v) { p.maxDepth = static_cast<int>(v); } },
+        { "min_terms", [](GeneratorProfile& p, double v) { p.minTerms = static_cast<int>(v); } },
+        { "max_terms", [](GeneratorProfile& p, double v) { p.maxTerms = static_cast<int>(v); } },
+        { "binary_weight", [](GeneratorProfile& p, double v) { p.binaryWeight = v; } },
+        { "function_weight", [](GeneratorProfile& p, double v) { p.functionWeight = v; } },
+        { "number_weight", [](GeneratorProfile& p, double v) { p.numberWeight = v; } },
+        { "leaf_function_probability", [](GeneratorProfile& p, double v) { p.leafFunctionProbability = v; } },
+        { "weight_add", [](GeneratorProfile& p, double v) { p.operatorWeights[0] = v; } },
+        { "weight_sub", [](GeneratorProfile& p, double v) { p.operatorWeights[1] = v; } },
+        { "weight_mul", [](GeneratorProfile& p, double v) { p.operatorWeights[2] = v; } },
+        { "weight_div", [](GeneratorProfile& p, double v) { p.operatorWeights[3] = v; } },
+        { "weight_sin", [](GeneratorProfile& p, double v) { p.functionWeights[0] = v; } },
+        { "weight_cos", [](GeneratorProfile& p, double v) { p.functionWeights[1] = v; } },
+        { "weight_tan", [](GeneratorProfile& p, double v) { p.functionWeights[2] = v; } },
+        { "weight_arcsin", [](GeneratorProfile& p, double v) { p.functionWeights[3] = v; } },
+        { "weight_arccos", [](GeneratorProfile& p, double v) { p.functionWeights[4] = v; } },
+        { "number_min", [](GeneratorProfile& p, double v) { p.numberMin = v; } },
+        { "number_max", [](GeneratorProfile& p, double v) { p.numberMax = v; } },
+        { "error_probability", [](GeneratorProfile& p, double v) { p.errorProbability = v; } },
+        { "division_by_zero_probability", [](GeneratorProfile& p, double v) { p.divisionByZeroProbability = v; } },
+        { "duplicate_probability", [](GeneratorProfile& p, double v) { p.duplicateProbability = v; } },
+    };
+    return keys;
+}
+
+// Вероятность должна лежать в [0, 1]
+void checkProbability(double value, const char* name) {
+    if (!(value >= 0.0 && value <= 1.0)) {
+        throw std::runtime_error(std::string("Параметр ") + name + " должен быть в диапазоне [0, 1]");
+    }
+}
+
+// Веса неотрицательны, и хотя бы один положителен
+void checkWeights(const double* weights, std::size_t count, const char* name) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!(weights[i] >= 0.0)) {
+            throw std::runtime_error(std::string("Веса ") + name + " не могут быть отрицательными");
+        }
+        sum += weights[i];
+    }
+    if (sum <= 0.0) {
+        throw std::runtime_error(std::string("Хотя бы один из весов ") + name + " должен быть положительным");
+    }
+}
+
+} // namespace
+
+void GeneratorProfile::validate() const {
+    if (minDepth < 0 || maxDepth < minDepth) {
+        throw std::runtime_error("Некорректная глубина: нужно 0 <= min_depth <= max_depth");
+    }
+    if (maxDepth > 64) {
+        throw std::runtime_error("Слишком большая глубина: max_depth не больше 64");
+    }
+    if (minTerms < 1 || maxTerms < minTerms) {
+        throw std::runtime_error("Некорректное число слагаемых: нужно 1 <= min_terms <= max_terms");
+    }
+    const double nodeWeights[3] = { binaryWeight, functionWeight, numberWeight };
+    checkWeights(nodeWeights, 3, "узлов");
+    checkWeights(operatorWeights, 4, "операций");
+    checkWeights(functionWeights, 5, "функций");
+    if (!(numberMin < numberMax)) {
+        throw std::runtime_error("Некорректный диапазон чисел: нужно number_min < number_max");
+    }
+    checkProbability(leafFunctionProbability, "leaf_function_probability");
+    checkProbability(errorProbability, "error_probability");
+    checkProbability(divisionByZeroProbability, "division_by_zero_probability");
+    checkProbability(duplicateProbability, "duplicate_probability");
+}
+
+const std::vector<std::string_view>& generatorProfileNames() {
+    static const std::vector<std::string_view> names = {
+        "default", "shallow-wide", "very-deep", "trig-heavy", "error-heavy", "duplicate-heavy", "huge-line"
+    };
+    return names;
+}
+
+GeneratorProfile namedGeneratorProfile(std::string_view name) {
+    GeneratorProfile profile;
+    profile.name = std::string(name);
+
+    if (name == "default") {
+        return profile;
+    }
+    if (name == "shallow-wide") {
+        // Много неглубоких слагаемых: нагрузка на токенизатор, мало рекурсии в парсере
+        profile.minDepth = 1;
+        profile.maxDepth = 2;
+        profile.minTerms = 20;
+        profile.maxTerms = 40;
+        return profile;
+    }
+    if (name == "very-deep") {
+        // Длинные цепочки вложенных функций: глубокая рекурсия парсера и вычислителя
+        // arcsin/arccos и числа обрывают цепочку, поэтому их нет; ошибок меньше,
+        // иначе почти каждая строка из десятков узлов содержала бы ошибку
+        profile.minDepth = 40;
+        profile.maxDepth = 60;
+        profile.binaryWeight = 2.0;
+        profile.functionWeight = 17.0;
+        profile.numberWeight = 0.0;
+        profile.functionWeights[3] = 0.0;
+        profile.functionWeights[4] = 0.0;
+        profile.errorProbability = 0.002;
+        profile.divisionByZeroProbability = 0.001;
+        return profile;
+    }
+    if (name == "trig-heavy") {
+        // В основном функции: нагрузка на вычисление sin/cos/tan
+        profile.binaryWeight = 8.0;
+        profile.functionWeight = 11.0;
+        profile.leafFunctionProbability = 0.8;
+        profile.functionWeights[0] = 3.0; // sin, cos, tan продолжают рекурсию,
+        profile.functionWeights[1] = 3.0; // arcsin и arccos берут только число
+        profile.functionWeights[2] = 3.0;
+        return profile;
+    }
+    if (name == "error-heavy") {
+        // Каждая третья подстрока с ошибкой: нагрузка на пути ошибок и запись сообщений
+        profile.errorProbability = 0.3;
+        profile.divisionByZeroProbability = 0.1;
+        return profile;
+    }
+    if (name == "duplicate-heavy") {
+        // Половина строк повторяет предыдущую
+        profile.duplicateProbability = 0.5;
+        return profile;
+    }
+    if (name == "huge-line") {
+        // Строки в десятки килобайт: нагрузка на чтение и запись длинных строк
+        profile.minDepth = 5;
+        profile.maxDepth = 6;
+        profile.minTerms = 200;
+        profile.maxTerms = 400;
+        profile.errorProbability = 0.00002; // Иначе в каждой строке из тысяч узлов была бы ошибка
+        profile.divisionByZeroProbability = 0.00001;
+        return profile;
+    }
+    throw std::runtime_error("Неизвестный профиль нагрузки: " + std::string(name));
+}
+
+GeneratorProfile loadGeneratorProfile(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    if (!input.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл параметров: " + path.string());
+    }
+
+    GeneratorProfile profile;
+    profile.name = path.filename().string();
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error("Файл параметров, строка " + std::to_string(lineNumber) + ": ожидается ключ = значение");
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        // Встроенный профиль как основа: заменяет все заданные ранее значения
+        if (key == "profile") {
+            std::string name = profile.name;
+            profile = namedGeneratorProfile(value);
+            profile.name = name;
+            continue;
+        }
+
+        auto setter = profileKeys().find(key);
+        if (setter == profileKeys().end()) {
+            throw std::runtime_error("Файл параметров, строка " + std::to_string(lineNumber) + ": неизвестный ключ " + key);
+        }
+        try {
+            std::size_t parsed = 0;
+            double number = std::stod(value, &parsed);
+            if (parsed != value.size()) {
+                throw std::invalid_argument(value);
+            }
+            setter->second(profile, number);
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("Файл параметров, строка " + std::to_string(lineNumber) + ": некорректное число " + value);
+        }
+    }
+
+    profile.validate();
+    return profile;
+}
@@ -0,0 +1,216 @@
+#include "input_source.hpp"
+
+#include "trace_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace expr {
+
+InputSource::InputSource(const std::filesystem::path& path) {
+    if (mapFile(path)) {
+        return;
+    }
+
+    // Запасной путь: каналы, устройства и платформы без mmap.
+    // Дескриптор, открытый при попытке отображения, используется повторно:
+    // повторное открытие канала потеряло бы уже записанные в него данные.
+#ifndef _WIN32
+    if (openedFd >= 0) {
+        stream = fdopen(openedFd, "rb");
+        if (stream == nullptr) {
+            close(openedFd);
+        }
+    }
+    else
+#endif
+    {
+        stream = path == "-" ? stdin : std::fopen(path.string().c_str(), "rb");
+    }
+    if (stream == nullptr) {
+        throw std::runtime_error("Не удалось открыть входной файл");
+    }
+    // Читаем крупными блоками сами, буфер stdio только мешает
+    std::setvbuf(stream, nullptr, _IONBF, 0);
+}
+
+InputSource::~InputSource() {
+#ifndef _WIN32
+    if (mapped && mappedSize > 0) {
+        munmap(const_cast<char*>(mappedData), mappedSize);
+    }
+#endif
+    if (stream != nullptr) {
+        std::fclose(stream);
+    }
+}
+
+// Отображение обычного файла в память
+bool InputSource::mapFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    (void)path;
+    return false;
+#else
+    // "-" — стандартный ввод: берем копию дескриптора, чтобы деструктор не закрыл stdin.
+    // Перенаправленный обычный файл так же отображается в память, канал читается блоками.
+    int fd = path == "-" ? dup(STDIN_FILENO) : open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Не удалось открыть входной файл");
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        openedFd = fd; // Канал или устройство: читаем блоками из этого же дескриптора
+        return false;
+    }
+
+    mappedSize = static_cast<std::size_t>(info.st_size);
+    if (mappedSize == 0) {
+        // Пустой файл отобразить нельзя, но и читать нечего
+        close(fd);
+        mapped = true;
+        return true;
+    }
+
+    void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // Отображение остается действительным и после закрытия дескриптора
+    if (address == MAP_FAILED) {
+        mappedSize = 0;
+        return false;
+    }
+
+    // Подсказки ядру: читаем последовательно, крупные страницы по возможности.
+    // Ошибки здесь не критичны — это только рекомендации.
+    madvise(address, mappedSize, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(address, mappedSize, MADV_HUGEPAGE);
+#endif
+
+    mappedData = static_cast<const char*>(address);
+    mapped = true;
+    return true;
+#endif
+}
+
+// Выдача следующей строки
+bool InputSource::nextLine(std::string_view& line) {
+    if (mapped) {
+        if (position >= mappedSize) {
+            return false;
+        }
+        const char* start = mappedData + position;
+        std::size_t remaining = mappedSize - position;
+        const void* newline = std::memchr(start, '\n', remaining);
+        std::size_t length = newline != nullptr
+            ? static_cast<std::size_t>(static_cast<const char*>(newline) - start)
+            : remaining;
+        line = std::string_view(start, length);
+        lastLineOffset = position;
+        position += std::min(length + 1, remaining);
+        return true;
+    }
+
+    while (true) {
+        if (!blocks.empty()) {
+            Block& current = blocks.back();
+            const char* start = current.bytes.get() + position;
+            std::size_t remaining = current.size - position;
+            const void* newline = std::memchr(start, '\n', remaining);
+            if (newline != nullptr) {
+                std::size_t length = static_cast<std::size_t>(static_cast<const char*>(newline) - start);
+                line = std::string_view(start, length);
+                lastLineOffset = current.baseOffset + position;
+                position += length + 1;
+                return true;
+            }
+            if (streamEnded) {
+                if (remaining == 0) {
+                    return false;
+                }
+                // Последняя строка без завершающего '\n'
+                line = std::string_view(start, remaining);
+                lastLineOffset = current.baseOffset + position;
+                position = current.size;
+                return true;
+            }
+        }
+        if (!refill() && blocks.empty()) {
+            return false;
+        }
+    }
+}
+
+// Чтение следующего блока запасного пути
+bool InputSource::refill() {
+    if (streamEnded) {
+        return false;
+    }
+    TraceSpan span("чтение блока");
+
+    // Незавершенная строка из текущего блока переносится в начало нового
+    const char* tail = nullptr;
+    std::size_t tailSize = 0;
+    std::uint64_t tailOffset = 0;
+    if (!blocks.empty()) {
+        tail = blocks.back().bytes.get() + position;
+        tailSize = blocks.back().size - position;
+        tailOffset = blocks.back().baseOffset + position;
+    }
+
+    Block block;
+    block.baseOffset = tailOffset;
+    block.capacity = std::max(kBlockSize, tailSize * 2);
+    block.bytes = std::make_unique<char[]>(block.capacity);
+    if (tailSize > 0) {
+        std::memcpy(block.bytes.get(), tail, tailSize);
+    }
+
+    std::size_t bytesRead = std::fread(block.bytes.get() + tailSize, 1, block.capacity - tailSize, stream);
+    if (bytesRead == 0) {
+        if (std::ferror(stream)) {
+            throw std::runtime_error("Ошибка чтения входного файла");
+        }
+        streamEnded = true;
+    }
+    block.size = tailSize + bytesRead;
+    span.setCount(bytesRead);
+
+    // Старые блоки не освобождаются: на них могут ссылаться уже выданные строки
+    blocks.push_back(std::move(block));
+    position = 0;
+    return bytesRead > 0;
+}
+
+// Поиск текста по смещению: в отображении напрямую, в блоках — начиная с новых,
+// потому что записываемые строки почти всегда лежат в последнем блоке
+std::string_view InputSource::text(std::uint64_t offset, std::size_t length) const {
+    if (mapped) {
+        return { mappedData + offset, length };
+    }
+    if (length == 0) {
+        return {};
+    }
+    for (auto block = blocks.rbegin(); block != blocks.rend(); ++block) {
+        if (offset >= block->baseOffset && offset + length <= block->baseOffset + block->size) {
+            return { block->bytes.get() + (offset - block->baseOffset), length };
+        }
+    }
+    throw std::runtime_error("Текст строки уже освобожден из входного буфера");
+}
+
+// Освобождение блоков, на которые больше никто не ссылается
+void InputSource::release() {
+    if (blocks.size() > 1) {
+        blocks.erase(blocks.begin(), blocks.end() - 1);
+    }
+}
+
+} // namespace expr
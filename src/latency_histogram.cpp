@@ -0,0 +1,57 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace expr {
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value) {
+    if (value < kLinearLimit) {
+        return static_cast<std::size_t>(value);
+    }
+    // Старший бит задает степень двойки, три следующих — корзину внутри нее
+    std::size_t exponent = static_cast<std::size_t>(std::bit_width(value)) - 1; // >= 4
+    std::size_t sub = static_cast<std::size_t>(value >> (exponent - 3)) & (kSubBuckets - 1);
+    return kLinearLimit + (exponent - 4) * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketValue(std::size_t index) {
+    if (index < kLinearLimit) {
+        return index;
+    }
+    std::size_t exponent = (index - kLinearLimit) / kSubBuckets + 4;
+    std::size_t sub = (index - kLinearLimit) % kSubBuckets;
+    std::uint64_t width = std::uint64_t{ 1 } << (exponent - 3);
+    std::uint64_t low = (kSubBuckets + sub) * width;
+    return low + width / 2;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    maximum = std::max(maximum, other.maximum);
+}
+
+std::uint64_t LatencyHistogram::percentile(double quantile) const {
+    if (total == 0) {
+        return 0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(total)));
+    rank = std::clamp<std::uint64_t>(rank, 1, total);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Середина корзины не может быть больше самого большого измерения
+            return std::min(bucketValue(i), maximum);
+        }
+    }
+    return maximum;
+}
+
+} // namespace expr
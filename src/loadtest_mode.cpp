@@ -0,0 +1,285 @@
+#include "loadtest_mode.hpp"
+#include "alloc_tracking.hpp"
+#include "bounded_queue.hpp"
+#include "console.hpp"
+#include "evaluator.hpp"
+#include "fast_expression_generator.hpp"
+#include "latency_histogram.hpp"
+#include "random_streams.hpp"
+#include "thread_pool.hpp"
+#include "user_input.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Выражений в одной пачке очереди: блокировка очереди делится на всю пачку
+constexpr std::size_t kLoadBatchSize = 256;
+
+// Пачек в очереди между генераторами и вычислением
+constexpr std::size_t kLoadQueueCapacity = 64;
+
+// Пачка сгенерированных выражений
+struct GeneratedBatch {
+    std::string text;              // Выражения подряд, каждое завершается '\n'
+    Clock::time_point produced;    // Момент, когда пачка готова (начало отсчета задержки)
+};
+
+// Счетчики одного потока генерации
+struct ProducerStats {
+    std::uint64_t expressions = 0;
+    std::uint64_t bytes = 0;
+    Clock::duration generateTime{ 0 }; // Генерация выражений
+    Clock::duration blockedTime{ 0 };  // Ожидание места в очереди
+};
+
+// Счетчики одного потока вычисления
+struct ConsumerStats {
+    std::uint64_t expressions = 0;
+    std::uint64_t errors = 0;
+    Clock::duration evaluateTime{ 0 }; // Токенизация, разбор и вычисление
+    Clock::duration waitTime{ 0 };     // Ожидание пачки в пустой очереди
+    expr::LatencyHistogram evaluation; // Время вычисления одного выражения
+    expr::LatencyHistogram endToEnd;   // От готовности пачки до результата выражения
+};
+
+// Поток генерации: пачки выражений до остановки или исчерпания квоты
+ProducerStats produce(std::size_t producerIndex, std::uint64_t seed, const GeneratorProfile& profile,
+    const LoadTestLimit& limit, std::atomic<std::size_t>& reserved, const std::atomic<bool>& stop,
+    expr::BoundedQueue<GeneratedBatch>& queue) {
+    ProducerStats stats;
+    FastExpressionGenerator generator(deriveStreamSeed(seed, producerIndex), profile);
+    std::size_t lineIndex = 0;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        // В режиме по количеству потоки делят общую квоту пачками
+        std::size_t count = kLoadBatchSize;
+        if (limit.expressionCount > 0) {
+            std::size_t taken = reserved.fetch_add(kLoadBatchSize, std::memory_order_relaxed);
+            if (taken >= limit.expressionCount) {
+                break;
+            }
+            count = std::min(kLoadBatchSize, limit.expressionCount - taken);
+        }
+
+        GeneratedBatch batch;
+        batch.text.reserve(count * 160);
+        Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            generator.generateLine(batch.text, lineIndex++);
+            batch.text.push_back('\n');
+        }
+        batch.produced = Clock::now();
+        stats.generateTime += batch.produced - start;
+        stats.expressions += count;
+        stats.bytes += batch.text.size();
+
+        Clock::time_point produced = batch.produced;
+        if (!queue.push(std::move(batch))) {
+            break;
+        }
+        stats.blockedTime += Clock::now() - produced;
+    }
+    return stats;
+}
+
+// Поток вычисления: забирает пачки, пока очередь не закрыта и не пуста
+ConsumerStats consume(const expr::ExpressionEvaluator& evaluator, expr::BoundedQueue<GeneratedBatch>& queue,
+    std::atomic<std::uint64_t>& completed) {
+    ConsumerStats stats;
+    double checksum = 0.0; // Чтобы вычисление не выбросил оптимизатор
+
+    while (true) {
+        Clock::time_point waitStart = Clock::now();
+        std::optional<GeneratedBatch> batch = queue.pop();
+        Clock::time_point previous = Clock::now();
+        stats.waitTime += previous - waitStart;
+        if (!batch) {
+            break;
+        }
+
+        std::string_view text = batch->text;
+        std::size_t position = 0;
+        std::uint64_t lines = 0;
+        while (position < text.size()) {
+            std::size_t newline = text.find('\n', position);
+            std::string_view line = text.substr(position, newline - position);
+            position = newline + 1;
+
+            try {
+                checksum += evaluator.evaluate(line);
+            }
+            catch (const std::exception&) {
+                ++stats.errors;
+            }
+
+            // Конец одного выражения — начало следующего, поэтому один замер времени на выражение
+            Clock::time_point now = Clock::now();
+            stats.evaluation.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(now - previous).count()));
+            stats.endToEnd.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(now - batch->produced).count()));
+            stats.evaluateTime += now - previous;
+            previous = now;
+            ++lines;
+        }
+        stats.expressions += lines;
+        completed.fetch_add(lines, std::memory_order_relaxed);
+    }
+
+    volatile double sink = checksum;
+    (void)sink;
+    return stats;
+}
+
+// Миллисекунды суммарного времени
+long long toMilliseconds(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+}
+
+// Строка перцентилей гистограммы в микросекундах
+void printPercentiles(const char* label, const expr::LatencyHistogram& histogram) {
+    auto micros = [](std::uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+    std::cout << label << Color::MAGENTA << std::fixed << std::setprecision(1)
+        << "p50 " << micros(histogram.percentile(0.5)) << " мкс, "
+        << "p99 " << micros(histogram.percentile(0.99)) << " мкс, "
+        << "p99.9 " << micros(histogram.percentile(0.999)) << " мкс, "
+        << "макс. " << micros(histogram.max()) << " мкс" << Color::RESET << "\n";
+}
+
+} // namespace
+
+// Нагрузочный режим
+void runLoadTestMode() {
+    printHeader();
+
+    std::cout << Color::BOLD << Color::CYAN << "Нагрузочный режим (без записи на диск)\n" << Color::RESET << "\n";
+
+    LoadTestLimit limit = askLoadTestLimit();
+    std::uint64_t seed = askGeneratorSeed();
+    GeneratorProfile profile = selectGeneratorProfile();
+    std::size_t producerCount = askProducerCount();
+    std::size_t threadCount = selectThreadCount();
+
+    std::cout << "\n";
+    std::cout << Color::BOLD << "Конфигурация:\n" << Color::RESET;
+    if (limit.expressionCount > 0) {
+        std::cout << "  Выражений:          " << Color::CYAN << limit.expressionCount << Color::RESET << "\n";
+    }
+    else {
+        std::cout << "  Длительность:       " << Color::CYAN << limit.seconds << " с" << Color::RESET << "\n";
+    }
+    std::cout << "  Зерно:              " << Color::CYAN << seed << Color::RESET << "\n";
+    std::cout << "  Профиль нагрузки:   " << Color::CYAN << profile.name << Color::RESET << "\n";
+    std::cout << "  Потоков генерации:  " << Color::CYAN << producerCount << Color::RESET << "\n";
+    std::cout << "  Потоков вычисления: " << Color::CYAN << threadCount << Color::RESET << "\n\n";
+
+    expr::ExpressionEvaluator evaluator;
+    expr::BoundedQueue<GeneratedBatch> queue(kLoadQueueCapacity);
+    std::atomic<bool> stop{ false };
+    std::atomic<std::size_t> reserved{ 0 };
+    std::atomic<std::uint64_t> completed{ 0 };
+
+    expr::ThreadPool producers(producerCount);
+    expr::ThreadPool consumers(threadCount);
+
+    std::cout << Color::BOLD << "Нагрузка..." << Color::RESET << "\n";
+    expr::resetStageTimings();
+    expr::resetAllocations();
+    Clock::time_point start = Clock::now();
+
+    std::vector<std::future<ConsumerStats>> consumerResults;
+    for (std::size_t i = 0; i < consumers.size(); ++i) {
+        consumerResults.push_back(consumers.enqueue(
+            consume, std::cref(evaluator), std::ref(queue), std::ref(completed)));
+    }
+    std::vector<std::future<ProducerStats>> producerResults;
+    for (std::size_t i = 0; i < producers.size(); ++i) {
+        producerResults.push_back(producers.enqueue(
+            produce, i, seed, std::cref(profile), std::cref(limit), std::ref(reserved), std::cref(stop), std::ref(queue)));
+    }
+
+    // Ждем окончания по времени или по количеству, показывая текущую скорость
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(limit.seconds));
+    while (true) {
+        bool producersDone = std::all_of(producerResults.begin(), producerResults.end(), [](const std::future<ProducerStats>& result) {
+            return result.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+        });
+        if (producersDone || (limit.expressionCount == 0 && Clock::now() >= deadline)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::uint64_t done = completed.load(std::memory_order_relaxed);
+        std::cout << "\r  " << Color::CYAN << done << " выражений, "
+            << static_cast<std::uint64_t>(done / seconds) << " выр/сек" << Color::RESET << "    " << std::flush;
+    }
+
+    // Останавливаем генерацию, затем даем вычислению разобрать остаток очереди
+    stop = true;
+    ProducerStats produced;
+    for (std::future<ProducerStats>& result : producerResults) {
+        ProducerStats stats = result.get();
+        produced.expressions += stats.expressions;
+        produced.bytes += stats.bytes;
+        produced.generateTime += stats.generateTime;
+        produced.blockedTime += stats.blockedTime;
+    }
+    queue.close();
+    ConsumerStats consumed;
+    for (std::future<ConsumerStats>& result : consumerResults) {
+        ConsumerStats stats = result.get();
+        consumed.expressions += stats.expressions;
+        consumed.errors += stats.errors;
+        consumed.evaluateTime += stats.evaluateTime;
+        consumed.waitTime += stats.waitTime;
+        consumed.evaluation.merge(stats.evaluation);
+        consumed.endToEnd.merge(stats.endToEnd);
+    }
+    Clock::time_point end = Clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "\r  " << Color::GREEN << "✓" << Color::RESET << " (" << consumed.expressions << " выражений, "
+        << toMilliseconds(end - start) << " мс)                    \n\n";
+
+    std::cout << Color::BOLD << "Статистика:\n" << Color::RESET;
+    std::cout << "  Всего выражений:    " << Color::CYAN << consumed.expressions << Color::RESET << "\n";
+    std::cout << "  Ошибок:             " << Color::RED << consumed.errors << Color::RESET << "\n";
+    if (seconds > 0) {
+        std::cout << "  Производительность: " << Color::YELLOW
+            << static_cast<std::uint64_t>(consumed.expressions / seconds) << " выр/сек, "
+            << std::fixed << std::setprecision(1) << produced.bytes / (1024.0 * 1024.0) / seconds << " МБ/с" << Color::RESET << "\n";
+    }
+
+    // Время этапов складывается по всем потокам этапа
+    std::cout << Color::BOLD << "  Этапы (сумма по потокам):\n" << Color::RESET;
+    std::cout << "    Генерация:        " << Color::MAGENTA << toMilliseconds(produced.generateTime) << " мс"
+        << ", ожидание места в очереди " << toMilliseconds(produced.blockedTime) << " мс" << Color::RESET << "\n";
+    std::cout << "    Вычисление:       " << Color::MAGENTA << toMilliseconds(consumed.evaluateTime) << " мс"
+        << ", ожидание пачки " << toMilliseconds(consumed.waitTime) << " мс" << Color::RESET << "\n";
+    printPercentiles("  Вычисление выражения: ", consumed.evaluation);
+    printPercentiles("  Задержка от генерации: ", consumed.endToEnd);
+    std::cout << "\n";
+
+    if constexpr (expr::kStageTimingEnabled) {
+        printStageTimings(expr::collectStageTimings());
+        std::cout << "\n";
+    }
+
+    if constexpr (expr::kAllocTrackingEnabled) {
+        printAllocationReport(expr::collectAllocations(), consumed.expressions);
+        std::cout << "\n";
+    }
+}
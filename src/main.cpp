@@ -3,24 +3,67 @@
 #include <chrono>
 #include <filesystem>
 #include <functional>
+#include <iomanip>
 #include <iostream>
-#include <map>
-#include <mutex>
+#include <memory>
 #include <thread>
 #include <vector>
 
+#include "alloc_tracking.hpp"
+#include "batch_mode.hpp"
+#include "columnar_reader.hpp"
 #include "console.hpp"
-#include "csv_writer.hpp"
 #include "evaluator.hpp"
 #include "expression_processor.hpp"
 #include "file_utils.hpp"
 #include "generate_mode.hpp"
+#include "loadtest_mode.hpp"
+#include "input_source.hpp"
+#include "metrics_exporter.hpp"
 #include "progress_bar.hpp"
+#include "result_writer.hpp"
+#include "slot_reader.hpp"
+#include "slot_writer.hpp"
+#include "slow_line_tracker.hpp"
 #include "thread_pool.hpp"
+#include "trace_recorder.hpp"
 #include "user_input.hpp"
 
 // Точка входа в программу
 int main(int argc, char** argv) {
+    // Преобразование колоночного файла результатов в CSV:
+    // expression_parser convert <файл.col|файл.slots> <файл.csv>
+    if (argc >= 2 && std::string(argv[1]) == "convert") {
+        try {
+            if (argc < 4) {
+                throw std::runtime_error("Использование: expression_parser convert <файл.col> <файл.csv>");
+            }
+            std::uint64_t rows = expr::isSlotFile(argv[2])
+                ? expr::convertSlotsToCsv(argv[2], argv[3])
+                : expr::convertColumnarToCsv(argv[2], argv[3]);
+            std::cout << Color::GREEN << "✓ " << Color::RESET << rows << " строк записано в " << argv[3] << "\n";
+            return 0;
+        }
+        catch (const std::exception& ex) {
+            std::cerr << Color::RED << Color::BOLD << "✗ Ошибка: "
+                << Color::RESET << Color::RED << ex.what() << Color::RESET << "\n\n";
+            return 1;
+        }
+    }
+
+    // Нагрузочный режим: генерация и вычисление в памяти, без диска
+    if (argc >= 2 && std::string(argv[1]) == "loadtest") {
+        try {
+            runLoadTestMode();
+            return 0;
+        }
+        catch (const std::exception& ex) {
+            std::cerr << Color::RED << Color::BOLD << "✗ Ошибка: "
+                << Color::RESET << Color::RED << ex.what() << Color::RESET << "\n\n";
+            return 1;
+        }
+    }
+
     // Проверяем, запущен ли режим генерации
     if (argc >= 2 && std::string(argv[1]) == "generate") {
         try {
@@ -34,6 +77,12 @@ int main(int argc, char** argv) {
         }
     }
 
+    // Неинтерактивный режим: все настройки заданы ключами командной строки
+    // (expression_parser -i вход -o выход ...), без вопросов и ожидания ввода
+    if (argc >= 2 && argv[1][0] == '-') {
+        return runBatchMode(argc, argv);
+    }
+
     printHeader();
 
     bool continueProcessing = true;
@@ -49,103 +98,223 @@ int main(int argc, char** argv) {
             // Интерактивный ввод количества потоков
             std::size_t threadCount = selectThreadCount();
 
+            // Дополнительные настройки (режим чтения и т.д.)
+            ProcessingOptions options = selectProcessingOptions();
+            if (options.outputFormat == expr::OutputFormat::Columnar) {
+                outputPath.replace_extension(".col");
+            }
+            else if (options.outputFormat == expr::OutputFormat::Ndjson) {
+                outputPath.replace_extension(".ndjson");
+            }
+            else if (options.outputFormat == expr::OutputFormat::Slots) {
+                outputPath.replace_extension(".slots");
+                options.exactLineCount = true; // Размер файла задается числом строк
+            }
+
             std::cout << "\n";
 
             // Информация о конфигурации
             std::cout << Color::BOLD << "Конфигурация:\n" << Color::RESET;
             std::cout << "  Входной файл:  " << Color::YELLOW << inputPath << Color::RESET << "\n";
             std::cout << "  Выходной файл: " << Color::YELLOW << outputPath << Color::RESET << "\n";
-            std::cout << "  Потоков:       " << Color::CYAN << threadCount << Color::RESET << "\n\n";
+            std::cout << "  Потоков:       " << Color::CYAN << threadCount << Color::RESET << "\n";
+            std::cout << "  Режим чтения:  " << Color::CYAN
+                << (options.readMode == ReadMode::ByteRanges ? "по диапазонам байт" : "последовательный")
+                << Color::RESET << "\n\n";
+
+            // Входные строки читаются из отображения файла в память без копирования
+            expr::InputSource source(inputPath);
+            if (options.readMode == ReadMode::ByteRanges && !source.isMapped()) {
+                std::cout << Color::YELLOW << "Внимание: " << Color::RESET
+                    << "файл нельзя отобразить в память, используется последовательный режим\n";
+                options.readMode = ReadMode::Sequential;
+            }
+            if (options.outputFormat == expr::OutputFormat::Slots && !source.isMapped()) {
+                throw std::runtime_error("Позиционный формат требует входной файл, отображаемый в память: "
+                    "число строк нужно знать заранее");
+            }
 
-            // 0. Быстрый подсчет количества строк в файле
-            std::cout << Color::BOLD << "Подсчет строк в файле..." << Color::RESET << std::flush;
-            std::chrono::high_resolution_clock::time_point startCount = std::chrono::high_resolution_clock::now();
-            std::size_t totalLines = countLinesInFile(inputPath);
-            std::chrono::high_resolution_clock::time_point endCount = std::chrono::high_resolution_clock::now();
-            std::chrono::milliseconds countDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endCount - startCount);
-            std::cout << " " << Color::GREEN << "✓" << Color::RESET << " ("
-                << totalLines << " строк, " << countDuration.count() << " мс)\n\n";
+            // 0. Подсчет строк (по запросу) — отдельный проход по файлу.
+            // По умолчанию прогресс считается по обработанным байтам, и файл читается один раз.
+            std::size_t expectedLines = 0;
+            if (options.exactLineCount && source.isMapped()) {
+                std::cout << Color::BOLD << "Подсчет строк в файле..." << Color::RESET << std::flush;
+                std::chrono::high_resolution_clock::time_point startCount = std::chrono::high_resolution_clock::now();
+                expectedLines = countLines(source.data());
+                std::chrono::high_resolution_clock::time_point endCount = std::chrono::high_resolution_clock::now();
+                std::chrono::milliseconds countDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endCount - startCount);
+                std::cout << " " << Color::GREEN << "✓" << Color::RESET << " ("
+                    << expectedLines << " строк, " << countDuration.count() << " мс)\n\n";
+            }
+            std::uint64_t totalBytes = source.isMapped() ? source.data().size() : 0;
 
             // 1. Потоковое чтение и обработка файла по частям
             std::cout << Color::BOLD << "Обработка выражений:\n" << Color::RESET;
             std::chrono::high_resolution_clock::time_point startProcess = std::chrono::high_resolution_clock::now();
+            expr::resetStageTimings(); // Замеры этапов только этого файла
+            expr::resetAllocations();
+            if (!options.tracePath.empty()) {
+                expr::startTracing();
+                expr::setTraceThreadName("чтение и запись");
+            }
 
             expr::ExpressionEvaluator evaluator;
-            expr::ThreadPool pool(threadCount);
-            std::atomic<std::size_t> completed{ 0 }; // Счетчик обработанных задач
+            ProgressState progress; // Счетчики обработанных строк и байт
+            expr::ErrorCatalog errors; // Сообщения об ошибках, на которые ссылаются записи по коду
 
-            // Инициализируем CSV writer
-            expr::CsvWriter writer(outputPath);
+            // Самые медленные строки: время каждой строки измеряется, только если отчет нужен
+            std::unique_ptr<expr::SlowLineTracker> slowLines;
+            if (options.slowLineCount > 0) {
+                slowLines = std::make_unique<expr::SlowLineTracker>(options.slowLineCount);
+            }
 
-            // Используем map для хранения результатов в правильном порядке
-            // Ключ - номер строки, значение - результат
-            std::map<std::size_t, expr::EvaluationRecord> resultBuffer;
-            std::mutex bufferMutex; // Мьютекс для защиты буфера
+            // Пул объявлен после всего, на что ссылаются его задачи, и разрушается первым
+            expr::ThreadPool pool(threadCount);
 
-            // Счетчики для статистики
-            std::atomic<std::size_t> successCount{ 0 };
-            std::atomic<std::size_t> errorCount{ 0 };
+            // Инициализируем запись результатов в выбранном формате.
+            // Позиционному файлу сразу задается размер по числу строк.
+            std::unique_ptr<expr::ResultWriter> writer;
+            expr::SlotWriter* slotWriter = nullptr;
+            if (options.outputFormat == expr::OutputFormat::Slots) {
+                std::unique_ptr<expr::SlotWriter> slots = std::make_unique<expr::SlotWriter>(outputPath, errors, expectedLines);
+                slotWriter = slots.get();
+                writer = std::move(slots);
+            }
+            else {
+                writer = expr::makeResultWriter(
+                    options.outputFormat, outputPath, errors, options.numberFormat, options.writeBuffers, options.outputProfile);
+            }
 
-            // Ожидаемый следующий номер строки для записи
-            std::size_t nextLineToWrite = 1;
+            // Счетчики для статистики
+            std::size_t successCount = 0;
+            std::size_t errorCount = 0;
 
-            // Callback для обработки батча результатов
+            // Callback для обработки батча результатов.
+            // Функции обработки передают записи строго по порядку строк
+            // и всегда из одного потока, поэтому запись идет сразу, без буфера и мьютекса.
+            // Тексты выражений достаются из источника только здесь, в момент записи.
             std::function<void(const std::vector<expr::EvaluationRecord>&)> processBatch = [&](const std::vector<expr::EvaluationRecord>& batch) {
-                // Добавляем результаты в буфер и записываем последовательные результаты
-                std::lock_guard<std::mutex> lock(bufferMutex);
+                expr::StageScope writeScope(expr::Stage::Write);
+                expr::AllocationStageScope allocationStage(expr::Stage::Write);
+                expr::TraceSpan span("запись результатов", batch.size());
                 for (const expr::EvaluationRecord& record : batch) {
-                    resultBuffer[record.lineNumber] = record;
-
                     // Обновляем статистику
-                    if (record.status == "success") {
-                        successCount.fetch_add(1);
+                    if (record.succeeded()) {
+                        ++successCount;
                     }
                     else {
-                        errorCount.fetch_add(1);
+                        ++errorCount;
                     }
+                    writer->writeRecord(record, source.text(record.offset, record.length));
                 }
+            };
 
-                // Записываем все последовательные результаты, которые готовы
-                while (resultBuffer.find(nextLineToWrite) != resultBuffer.end()) {
-                    writer.writeRecord(resultBuffer[nextLineToWrite]);
-                    resultBuffer.erase(nextLineToWrite);
-                    ++nextLineToWrite;
+            // Файл метрик обновляется в фоне; экспортер объявлен после пула и записи
+            // результатов, поэтому останавливается раньше, чем они разрушаются
+            std::unique_ptr<expr::MetricsExporter> metrics;
+            if (!options.metricsPath.empty()) {
+                metrics = std::make_unique<expr::MetricsExporter>(options.metricsPath, options.metricsInterval, [&]() {
+                    expr::MetricsSample sample;
+                    sample.linesProcessed = progress.completedLines.load(std::memory_order_relaxed);
+                    sample.linesFailed = progress.failedLines.load(std::memory_order_relaxed);
+                    sample.bytesRead = progress.completedBytes.load(std::memory_order_relaxed);
+                    sample.bytesWritten = writer->bytesFlushed();
+                    sample.poolQueueDepth = pool.queuedTasks();
+                    sample.windowLines = progress.windowLines.load(std::memory_order_relaxed);
+                    return sample;
+                });
+            }
+
+            // Запуск отображения прогресса в отдельном потоке
+            std::thread progressThread(displayProgress, std::cref(progress), totalBytes, expectedLines, std::ref(std::cout));
+
+            // Количество строк становится известно только после чтения всего файла.
+            // Функции обработки возвращаются, когда все результаты уже переданы в callback.
+            std::size_t totalLines = 0;
+            try {
+                if (slotWriter != nullptr && options.readMode == ReadMode::Sequential) {
+                    // Рабочие потоки сами кладут результаты на место в файле, без упорядочивания
+                    std::atomic<std::size_t> failedLines{ 0 };
+                    std::atomic<std::size_t> rejectedLines{ 0 }; // Строки за пределами заранее подсчитанных
+                    totalLines = processExpressionsInPlace(source, evaluator, errors, slowLines.get(), pool, progress,
+                        [&](const expr::EvaluationRecord& record) {
+                            if (!record.succeeded()) {
+                                failedLines.fetch_add(1, std::memory_order_relaxed);
+                            }
+                            expr::StageScope writeScope(expr::Stage::Write);
+                            expr::AllocationStageScope allocationStage(expr::Stage::Write);
+                            if (!slotWriter->store(record)) {
+                                rejectedLines.fetch_add(1, std::memory_order_relaxed);
+                            }
+                        });
+                    // Исключение в рабочем потоке завершило бы программу, поэтому не поместившиеся
+                    // строки только считаются, а ошибка, как в SlotWriter::writeRecord, бросается здесь
+                    if (rejectedLines.load() > 0) {
+                        throw std::runtime_error(std::to_string(rejectedLines.load())
+                            + " строк больше заранее подсчитанного числа строк (файл изменился во время обработки?)");
+                    }
+                    errorCount = failedLines.load();
+                    successCount = totalLines - errorCount;
                 }
-            };
+                else if (options.readMode == ReadMode::ByteRanges) {
+                    // Каждый поток читает и обрабатывает свой диапазон байт
+                    totalLines = processExpressionsByRanges(source, evaluator, errors, slowLines.get(), pool, progress, processBatch);
+                }
+                else {
+                    // Читаем и обрабатываем файл по частям (streaming)
+                    totalLines = processExpressionsStreaming(source, evaluator, errors, slowLines.get(), pool, progress, processBatch);
+                }
+            }
+            catch (...) {
+                // Останавливаем поток прогресса, иначе std::thread завершит программу
+                progress.finished = true;
+                progressThread.join();
+                throw;
+            }
 
-            // Запуск отображения прогресса в отдельном потоке (сразу после подсчета строк)
-            std::thread progressThread(displayProgress, std::ref(completed), totalLines);
+            // Ожидание завершения потока прогресса
+            progress.finished = true;
+            progressThread.join();
 
-            // Читаем и обрабатываем файл по частям (streaming)
-            // Передаем totalLines как atomic для обновления, но уже знаем точное значение
-            std::atomic<std::size_t> totalLinesAtomic{ totalLines };
-            processExpressionsStreaming(inputPath, evaluator, pool, completed, totalLinesAtomic, processBatch);
+            // Дописываем буфер на диск и закрываем файл
+            std::cout << "\n" << Color::BOLD << "Запись результатов..." << Color::RESET << std::flush;
+            writer->close();
+            std::cout << " " << Color::GREEN << "✓" << Color::RESET << "\n\n";
 
-            // Ждем завершения всех задач
-            while (completed.load() < totalLines) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Последний снимок метрик с итоговыми счетчиками и running = 0
+            if (metrics != nullptr) {
+                metrics->stop();
+                std::cout << Color::GREEN << "Метрики сохранены в: " << options.metricsPath << Color::RESET << "\n\n";
             }
 
-            // Обрабатываем оставшиеся результаты в буфере
-            {
-                std::lock_guard<std::mutex> lock(bufferMutex);
-                for (const std::pair<const std::size_t, expr::EvaluationRecord>& pair : resultBuffer) {
-                    writer.writeRecord(pair.second);
+            // Отчет о самых медленных строках рядом с результатами
+            if (slowLines != nullptr) {
+                std::filesystem::path slowPath = outputPath.parent_path() / (outputPath.stem().string() + "_slowest.csv");
+                slowLines->writeReport(slowPath);
+                std::vector<expr::SlowLine> slowest = slowLines->slowest();
+                if (!slowest.empty()) {
+                    std::cout << Color::YELLOW << "Самая медленная строка: " << slowest.front().lineNumber << " ("
+                        << slowest.front().cpuNanoseconds / 1000 << " мкс процессорного времени, "
+                        << slowest.front().nodeCount << " узлов)"
+                        << Color::RESET << "\n";
                 }
+                std::cout << Color::GREEN << "Отчет о " << slowest.size() << " самых медленных строках сохранен в: "
+                    << slowPath << Color::RESET << "\n\n";
             }
 
-            // Ожидание завершения потока прогресса
-            progressThread.join();
+            // Трассировка сохраняется, пока пул жив и его потоки простаивают
+            if (!options.tracePath.empty()) {
+                std::size_t events = expr::writeChromeTrace(options.tracePath);
+                std::cout << Color::GREEN << "Трассировка (" << events << " событий) сохранена в: "
+                    << options.tracePath << Color::RESET << "\n\n";
+            }
 
             std::chrono::high_resolution_clock::time_point endProcess = std::chrono::high_resolution_clock::now();
             std::chrono::milliseconds processDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endProcess - startProcess);
 
-            std::cout << "\n" << Color::BOLD << "Запись результатов..." << Color::RESET << std::flush;
-            std::cout << " " << Color::GREEN << "✓" << Color::RESET << "\n\n";
-
             // 4. Вывод итоговой статистики
-            std::size_t finalSuccess = successCount.load();
-            std::size_t finalError = errorCount.load();
+            std::size_t finalSuccess = successCount;
+            std::size_t finalError = errorCount;
 
             std::cout << Color::BOLD << "Статистика:\n" << Color::RESET;
             std::cout << "  Всего выражений:  " << Color::CYAN << totalLines << Color::RESET << "\n";
@@ -156,6 +325,37 @@ int main(int argc, char** argv) {
             std::cout << "  Время обработки:  " << Color::MAGENTA << processDuration.count()
                 << " мс" << Color::RESET << "\n";
 
+            // Объем записи и время, проведенное в системных вызовах записи
+            const expr::WriteStats& writeStats = writer->stats();
+            std::chrono::milliseconds writeDuration = std::chrono::duration_cast<std::chrono::milliseconds>(writeStats.writeTime);
+            std::cout << "  Запись на диск:   " << Color::MAGENTA
+                << writeStats.bytesWritten / (1024 * 1024) << " МБ, "
+                << writeStats.flushCount << " сбросов, " << writeDuration.count() << " мс";
+            if (writeStats.writeTime.count() > 0) {
+                double seconds = std::chrono::duration<double>(writeStats.writeTime).count();
+                std::cout << " (" << static_cast<int>(writeStats.bytesWritten / (1024.0 * 1024.0) / seconds) << " МБ/с)";
+            }
+            std::cout << Color::RESET << "\n";
+
+            // Пропускная способность вывода при выбранном профиле: сколько строк и байт
+            // результата получено за секунду всей обработки
+            std::cout << "  Профиль вывода:   " << Color::MAGENTA << expr::profileName(options.outputProfile)
+                << ", " << writer->recordsWritten() << " строк";
+            if (processDuration.count() > 0) {
+                double seconds = processDuration.count() / 1000.0;
+                std::cout << " (" << static_cast<std::uint64_t>(writer->recordsWritten() / seconds) << " строк/с, "
+                    << std::fixed << std::setprecision(1) << writeStats.bytesWritten / (1024.0 * 1024.0) / seconds << " МБ/с)";
+            }
+            std::cout << Color::RESET << "\n";
+            if (options.writeBuffers >= 2 && slotWriter == nullptr) {
+                // Если диск не успевает, очередь растет и чтение ждет свободный буфер.
+                // Позиционный файл пишется через отображение, очереди записи у него нет.
+                std::chrono::milliseconds stallDuration = std::chrono::duration_cast<std::chrono::milliseconds>(writeStats.stallTime);
+                std::cout << "  Очередь записи:   " << Color::MAGENTA << "макс. " << writeStats.maxQueueDepth
+                    << ", в среднем " << std::fixed << std::setprecision(2) << writeStats.averageQueueDepth()
+                    << ", ожидание буфера " << stallDuration.count() << " мс" << Color::RESET << "\n";
+            }
+
             // Расчет производительности (выражений в секунду)
             if (processDuration.count() > 0) {
                 std::cout << "  Производительность: " << Color::YELLOW
@@ -163,6 +363,18 @@ int main(int argc, char** argv) {
                     << " выр/сек" << Color::RESET << "\n\n";
             }
 
+            // Время по этапам есть только в сборке с EXPR_STAGE_TIMING
+            if constexpr (expr::kStageTimingEnabled) {
+                printStageTimings(expr::collectStageTimings());
+                std::cout << "\n";
+            }
+
+            // Выделения памяти по этапам есть только в сборке с EXPR_ALLOC_TRACKING
+            if constexpr (expr::kAllocTrackingEnabled) {
+                printAllocationReport(expr::collectAllocations(), totalLines);
+                std::cout << "\n";
+            }
+
             std::cout << Color::GREEN << "Результаты сохранены в: " << outputPath << Color::RESET << "\n\n";
 
             // Спрашиваем, хочет ли пользователь продолжить
@@ -0,0 +1,120 @@
+#include "metrics_exporter.hpp"
+
+#include "alloc_tracking.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace expr {
+
+namespace {
+
+// Текущий объем резидентной памяти процесса (0, если неизвестен)
+std::uint64_t currentResidentBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long long totalPages = 0;
+    unsigned long long residentPages = 0;
+    int fields = std::fscanf(statm, "%llu %llu", &totalPages, &residentPages);
+    std::fclose(statm);
+    if (fields != 2) {
+        return 0;
+    }
+    return residentPages * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Одна метрика с описанием и типом
+template <class Value>
+void metric(std::ofstream& out, const char* name, const char* type, const char* help, Value value) {
+    out << "# HELP expression_parser_" << name << ' ' << help << '\n'
+        << "# TYPE expression_parser_" << name << ' ' << type << '\n'
+        << "expression_parser_" << name << ' ' << value << '\n';
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(std::filesystem::path path, std::chrono::milliseconds interval,
+    std::function<MetricsSample()> sampler)
+    : path(std::move(path)), interval(interval), sampler(std::move(sampler)),
+      started(std::chrono::steady_clock::now()), previousTime(started) {
+    write(true);
+    worker = std::thread([this]() { run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    write(false);
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this]() { return stopping; })) {
+        lock.unlock();
+        write(true);
+        lock.lock();
+    }
+}
+
+void MetricsExporter::write(bool running) {
+    MetricsSample sample = sampler();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - previousTime).count();
+    double rate = seconds > 0 ? static_cast<double>(sample.linesProcessed - previous.linesProcessed) / seconds : 0.0;
+    double errorRatio = sample.linesProcessed > 0
+        ? static_cast<double>(sample.linesFailed) / static_cast<double>(sample.linesProcessed) : 0.0;
+    previous = sample;
+    previousTime = now;
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        metric(out, "running", "gauge", "1 while a file is being processed", running ? 1 : 0);
+        metric(out, "uptime_seconds", "gauge", "Seconds since processing started",
+            std::chrono::duration<double>(now - started).count());
+        metric(out, "lines_processed_total", "counter", "Evaluated lines", sample.linesProcessed);
+        metric(out, "lines_failed_total", "counter", "Lines that ended with an error", sample.linesFailed);
+        metric(out, "error_ratio", "gauge", "Share of failed lines", errorRatio);
+        metric(out, "expressions_per_second", "gauge", "Evaluation rate since the previous update", rate);
+        metric(out, "input_bytes_read_total", "counter", "Input bytes consumed", sample.bytesRead);
+        metric(out, "output_bytes_written_total", "counter", "Result bytes written to disk", sample.bytesWritten);
+        metric(out, "pool_queue_depth", "gauge", "Tasks waiting in the thread pool queue", sample.poolQueueDepth);
+        metric(out, "reorder_window_lines", "gauge", "Lines handed to the pool and not yet written", sample.windowLines);
+        metric(out, "resident_memory_bytes", "gauge", "Current resident set size", currentResidentBytes());
+        metric(out, "peak_resident_memory_bytes", "gauge", "Peak resident set size", peakResidentBytes());
+        if (!out) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+} // namespace expr
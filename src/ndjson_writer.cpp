@@ -0,0 +1,216 @@
+#include "ndjson_writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace expr {
+
+namespace {
+
+// Шестнадцатеричные цифры для \u00XX
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Сколько байт строки экранируется за одно резервирование места в буфере
+constexpr std::size_t kEscapeChunk = 4096;
+
+// Нужно ли экранировать байт ASCII внутри строки JSON
+inline bool needsEscape(unsigned char ch) {
+    return ch < 0x20 || ch == '"' || ch == '\\';
+}
+
+// Длина корректной последовательности UTF-8 (RFC 3629), начинающейся с байта
+// text[position] >= 0x80, или 0, если последовательность неверна: лишний байт
+// продолжения, обрезанная последовательность, избыточная запись, суррогат или код > U+10FFFF
+inline std::size_t utf8SequenceLength(std::string_view text, std::size_t position) {
+    unsigned char lead = static_cast<unsigned char>(text[position]);
+    std::size_t length = 0;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) {
+            secondMin = 0xA0; // Избыточная запись
+        }
+        else if (lead == 0xED) {
+            secondMax = 0x9F; // Суррогаты U+D800..U+DFFF
+        }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) {
+            secondMin = 0x90; // Избыточная запись
+        }
+        else if (lead == 0xF4) {
+            secondMax = 0x8F; // Больше U+10FFFF
+        }
+    }
+    else {
+        return 0;
+    }
+    if (text.size() - position < length) {
+        return 0;
+    }
+    unsigned char second = static_cast<unsigned char>(text[position + 1]);
+    if (second < secondMin || second > secondMax) {
+        return 0;
+    }
+    for (std::size_t i = 2; i < length; ++i) {
+        if ((static_cast<unsigned char>(text[position + i]) & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+} // namespace
+
+NdjsonWriter::NdjsonWriter(const std::filesystem::path& path, const ErrorCatalog& errors, NumberFormat format,
+    std::size_t asyncBuffers, OutputProfile profile)
+    : ResultWriter(errors), file(path, BufferedFile::kDefaultBufferSize, asyncBuffers),
+      numberFormat(format), profile(profile) {
+}
+
+// Строка JSON пишется прямо в буфер файла кусками по kEscapeChunk байт: под каждый
+// кусок место резервируется с запасом на худший случай (каждый байт превращается
+// в \u00XX или \ufffd), специальные символы заменяются escape-последовательностями,
+// корректные последовательности UTF-8 копируются как есть, а каждый байт неверной
+// последовательности заменяется на \ufffd — иначе строгий разборщик отверг бы весь поток.
+// Последовательность UTF-8 может заходить за конец куска на 3 байта, под них запас отдельно.
+void NdjsonWriter::writeString(std::string_view text) {
+    file.append('"');
+    std::size_t position = 0;
+    while (position < text.size()) {
+        std::size_t chunkEnd = std::min(text.size(), position + kEscapeChunk);
+        char* out = file.reserve((chunkEnd - position) * 6 + 3);
+        char* begin = out;
+        while (position < chunkEnd) {
+            char raw = text[position];
+            unsigned char ch = static_cast<unsigned char>(raw);
+            if (ch >= 0x80) {
+                std::size_t length = utf8SequenceLength(text, position);
+                if (length == 0) {
+                    for (char replacement : { '\\', 'u', 'f', 'f', 'f', 'd' }) {
+                        *out++ = replacement;
+                    }
+                    ++position;
+                    continue;
+                }
+                for (std::size_t i = 0; i < length; ++i) {
+                    *out++ = text[position + i];
+                }
+                position += length;
+                continue;
+            }
+            ++position;
+            if (!needsEscape(ch)) {
+                *out++ = raw;
+                continue;
+            }
+            *out++ = '\\';
+            switch (ch) {
+            case '"':
+                *out++ = '"';
+                break;
+            case '\\':
+                *out++ = '\\';
+                break;
+            case '\n':
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = 't';
+                break;
+            case '\b':
+                *out++ = 'b';
+                break;
+            case '\f':
+                *out++ = 'f';
+                break;
+            default:
+                // Прочие управляющие символы: \u00XX
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = kHexDigits[ch >> 4];
+                *out++ = kHexDigits[ch & 0x0F];
+                break;
+            }
+        }
+        file.commit(static_cast<std::size_t>(out - begin));
+    }
+    file.append('"');
+}
+
+void NdjsonWriter::writeInteger(std::uint64_t value) {
+    char* text = file.reserve(32);
+    std::to_chars_result end = std::to_chars(text, text + 32, value);
+    file.commit(static_cast<std::size_t>(end.ptr - text));
+}
+
+void NdjsonWriter::writeValue(const EvaluationRecord& record) {
+    if (!record.succeeded() || !std::isfinite(record.value)) {
+        file.append("null");
+        return;
+    }
+    char* number = file.reserve(kMaxFormattedNumberLength);
+    char* numberEnd = formatNumber(number, record.value, numberFormat);
+    file.commit(static_cast<std::size_t>(numberEnd - number));
+}
+
+// Запись одного объекта. Имена полей — константы, поэтому пишутся вместе с разделителями.
+void NdjsonWriter::writeRecord(const EvaluationRecord& record, std::string_view expression) {
+    if (profile == OutputProfile::ErrorsOnly && record.succeeded()) {
+        return;
+    }
+
+    file.append("{\"line\":");
+    writeInteger(record.lineNumber);
+
+    switch (profile) {
+    case OutputProfile::Lean:
+        file.append(",\"status\":\"");
+        file.append(statusName(record.status()));
+        file.append("\",\"result\":");
+        writeValue(record);
+        file.append(",\"error_code\":");
+        writeInteger(record.errorCode);
+        break;
+    case OutputProfile::ErrorsOnly:
+        file.append(",\"expression\":");
+        writeString(expression);
+        file.append(",\"message\":");
+        writeString(errors.message(record.errorCode));
+        break;
+    case OutputProfile::Full:
+    default:
+        file.append(",\"expression\":");
+        writeString(expression);
+        file.append(",\"status\":\"");
+        file.append(statusName(record.status()));
+        file.append("\",\"result\":");
+        writeValue(record);
+        file.append(",\"message\":");
+        writeString(errors.message(record.errorCode));
+        break;
+    }
+    file.append("}\n");
+
+    ++recordCount;
+}
+
+void NdjsonWriter::flush() {
+    file.flush();
+}
+
+void NdjsonWriter::close() {
+    file.close();
+}
+
+} // namespace expr
@@ -1,35 +1,70 @@
 #include "progress_bar.hpp"
 #include "console.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
-#include <iostream>
+#include <ostream>
 #include <thread>
 
+namespace {
+// Перевод байт в мегабайты для вывода
+double toMegabytes(std::uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+}
+
 // Функция отображения прогресс-бара.
-void displayProgress(std::atomic<std::size_t>& completed, std::size_t total) {
+void displayProgress(const ProgressState& state, std::uint64_t totalBytes, std::size_t totalLines, std::ostream& out) {
     const int barWidth = 50;
-    while (completed < total) {
-        std::size_t current = completed.load();
-        float progress = static_cast<float>(current) / total;
+    while (!state.finished.load()) {
+        std::size_t lines = state.completedLines.load(std::memory_order_relaxed);
+        std::uint64_t bytes = state.completedBytes.load(std::memory_order_relaxed);
+
+        // Размер входа неизвестен (канал): шкалу не рисуем, только счетчики
+        if (totalLines == 0 && totalBytes == 0) {
+            out << "\r  " << Color::CYAN << "Обработано: " << Color::RESET
+                << std::fixed << std::setprecision(1) << toMegabytes(bytes) << " МБ, "
+                << lines << " строк";
+            out.flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+
+        float progress = 0.0f;
+        if (totalLines > 0) {
+            progress = static_cast<float>(lines) / totalLines;
+        }
+        else if (totalBytes > 0) {
+            progress = static_cast<float>(bytes) / totalBytes;
+        }
+        // Последняя строка без '\n' учитывается с лишним байтом
+        progress = std::min(progress, 1.0f);
         int pos = static_cast<int>(barWidth * progress);
 
-        std::cout << "\r  " << Color::CYAN << "[";
+        out << "\r  " << Color::CYAN << "[";
         for (int i = 0; i < barWidth; ++i) {
-            if (i < pos) std::cout << "█";
-            else if (i == pos) std::cout << "▒";
-            else std::cout << "░";
+            if (i < pos) out << "█";
+            else if (i == pos) out << "▒";
+            else out << "░";
+        }
+        out << "] " << Color::BOLD << std::setw(3) << static_cast<int>(progress * 100.0f)
+            << "%" << Color::RESET;
+        if (totalLines > 0) {
+            out << " (" << lines << "/" << totalLines << ")";
         }
-        std::cout << "] " << Color::BOLD << std::setw(3) << static_cast<int>(progress * 100.0f)
-            << "%" << Color::RESET << " (" << current << "/" << total << ")";
-        std::cout.flush();
+        else {
+            out << " (" << std::fixed << std::setprecision(1) << toMegabytes(bytes)
+                << "/" << toMegabytes(totalBytes) << " МБ, " << lines << " строк)";
+        }
+        out.flush();
 
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
     // Финальное обновление до 100%
-    std::cout << "\r  " << Color::GREEN << "[";
-    for (int i = 0; i < barWidth; ++i) std::cout << "█";
-    std::cout << "] " << Color::BOLD << "100%" << Color::RESET
-        << " (" << total << "/" << total << ")\n";
+    std::size_t lines = state.completedLines.load();
+    out << "\r  " << Color::GREEN << "[";
+    for (int i = 0; i < barWidth; ++i) out << "█";
+    out << "] " << Color::BOLD << "100%" << Color::RESET
+        << " (" << lines << "/" << lines << ")\n";
 }
-
@@ -0,0 +1,59 @@
+#include "reorder_window.hpp"
+
+#include <utility>
+
+namespace expr {
+
+ReorderWindow::ReorderWindow(std::size_t capacity, std::size_t firstLine)
+    : slots(capacity == 0 ? 1 : capacity), next(firstLine) {}
+
+// Запись результата в его ячейку
+void ReorderWindow::put(EvaluationRecord&& record) {
+    bool isNext = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& slot = slots[record.lineNumber % slots.size()];
+        isNext = record.lineNumber == next;
+        slot.record = std::move(record);
+        slot.ready = true;
+    }
+
+    // Будить читателя имеет смысл, только когда готова строка, которую он ждет
+    if (isNext) {
+        condition.notify_one();
+    }
+}
+
+// Выдача готовых записей по порядку
+bool ReorderWindow::takeReady(std::vector<EvaluationRecord>& out, bool wait) {
+    out.clear();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) {
+        condition.wait(lock, [this]() { return slots[next % slots.size()].ready; });
+    }
+
+    // Записи перемещаются, а не копируются; ячейка сразу освобождается для новой строки
+    while (true) {
+        Slot& slot = slots[next % slots.size()];
+        if (!slot.ready) {
+            break;
+        }
+        out.push_back(std::move(slot.record));
+        slot.ready = false;
+        ++next;
+    }
+    return !out.empty();
+}
+
+bool ReorderWindow::hasRoomFor(std::size_t lineNumber) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lineNumber < next + slots.size();
+}
+
+std::size_t ReorderWindow::nextLine() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return next;
+}
+
+} // namespace expr
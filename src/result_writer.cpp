@@ -0,0 +1,32 @@
+#include "result_writer.hpp"
+
+#include "columnar_writer.hpp"
+#include "csv_writer.hpp"
+#include "ndjson_writer.hpp"
+
+#include <stdexcept>
+
+namespace expr {
+
+// Выбор реализации по формату
+std::unique_ptr<ResultWriter> makeResultWriter(
+    OutputFormat format,
+    const std::filesystem::path& path,
+    const ErrorCatalog& errors,
+    NumberFormat numberFormat,
+    std::size_t asyncBuffers,
+    OutputProfile profile) {
+    switch (format) {
+    case OutputFormat::Columnar:
+        return std::make_unique<ColumnarWriter>(path, errors, asyncBuffers, kDefaultRowGroupSize, profile == OutputProfile::ErrorsOnly);
+    case OutputFormat::Ndjson:
+        return std::make_unique<NdjsonWriter>(path, errors, numberFormat, asyncBuffers, profile);
+    case OutputFormat::Slots:
+        throw std::invalid_argument("Позиционный формат создается напрямую через SlotWriter");
+    case OutputFormat::Csv:
+    default:
+        return std::make_unique<CsvWriter>(path, errors, numberFormat, asyncBuffers, profile);
+    }
+}
+
+} // namespace expr
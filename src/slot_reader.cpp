@@ -0,0 +1,130 @@
+#include "slot_reader.hpp"
+
+#include "buffered_file.hpp"
+#include "result_writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace expr {
+
+bool isSlotFile(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    char magic[sizeof(kSlotMagic)] = {};
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, kSlotMagic, sizeof(kSlotMagic)) == 0;
+}
+
+// Преобразование позиционного файла в CSV
+std::uint64_t convertSlotsToCsv(const std::filesystem::path& inputPath,
+    const std::filesystem::path& outputPath,
+    NumberFormat numberFormat) {
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Не удалось открыть позиционный файл: " + inputPath.string());
+    }
+    // Размер файла нужен, чтобы проверить счетчики из заголовка и словаря до выделения памяти
+    std::uint64_t fileSize = std::filesystem::file_size(inputPath);
+    if (fileSize < kSlotHeaderSize) {
+        throw std::runtime_error("Позиционный файл поврежден: слишком короткий");
+    }
+    auto read = [&input](void* data, std::size_t size) {
+        if (!input.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Позиционный файл поврежден: данные обрезаны");
+        }
+    };
+
+    SlotFileHeader header{};
+    read(&header, sizeof(header));
+    if (std::memcmp(header.magic, kSlotMagic, sizeof(kSlotMagic)) != 0) {
+        throw std::runtime_error("Файл не является позиционным файлом результатов");
+    }
+    if (header.version != kSlotVersion || header.slotSize != kSlotSize) {
+        throw std::runtime_error("Неподдерживаемая версия позиционного файла: " + std::to_string(header.version));
+    }
+    // Число записей проверяется до умножения, чтобы оно не переполнилось
+    if (header.slotCount > (fileSize - kSlotHeaderSize) / kSlotSize
+        || header.dictionaryOffset != kSlotHeaderSize + header.slotCount * kSlotSize) {
+        throw std::runtime_error("Позиционный файл поврежден: неверное смещение словаря");
+    }
+
+    // Словарь ошибок в конце файла; счетчики в нем ограничены оставшимися байтами
+    input.seekg(static_cast<std::streamoff>(header.dictionaryOffset));
+    std::uint64_t dictionaryRemaining = fileSize - header.dictionaryOffset;
+    auto readDictionary = [&](void* data, std::size_t size) {
+        if (size > dictionaryRemaining) {
+            throw std::runtime_error("Позиционный файл поврежден: словарь обрезан");
+        }
+        read(data, size);
+        dictionaryRemaining -= size;
+    };
+    std::uint32_t messageCount = 0;
+    readDictionary(&messageCount, sizeof(messageCount));
+    if (messageCount > dictionaryRemaining / sizeof(std::uint32_t)) { // У каждого сообщения есть хотя бы длина
+        throw std::runtime_error("Позиционный файл поврежден: счетчик в словаре больше размера файла");
+    }
+    std::vector<std::string> messages(messageCount);
+    for (std::string& message : messages) {
+        std::uint32_t length = 0;
+        readDictionary(&length, sizeof(length));
+        if (length > dictionaryRemaining) {
+            throw std::runtime_error("Позиционный файл поврежден: счетчик в словаре больше размера файла");
+        }
+        message.resize(length);
+        readDictionary(message.data(), length);
+    }
+
+    // Записи читаются пачками
+    BufferedFile output(outputPath);
+    output.append("line,status,result,message\n");
+    input.seekg(static_cast<std::streamoff>(kSlotHeaderSize));
+
+    std::vector<EvaluationRecord> chunk(65536);
+    std::uint64_t remaining = header.slotCount;
+    std::uint64_t converted = 0;
+    while (remaining > 0) {
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, chunk.size()));
+        read(chunk.data(), count * kSlotSize);
+        remaining -= count;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const EvaluationRecord& record = chunk[i];
+            if (record.lineNumber == 0) {
+                continue; // Запись не заполнена
+            }
+            if (record.errorCode > messages.size()) {
+                throw std::runtime_error("Позиционный файл поврежден: неизвестный код ошибки");
+            }
+
+            char* lineText = output.reserve(32);
+            std::to_chars_result lineEnd = std::to_chars(lineText, lineText + 32, record.lineNumber);
+            output.commit(static_cast<std::size_t>(lineEnd.ptr - lineText));
+            output.append(record.succeeded() ? ",success," : ",error,");
+
+            if (record.succeeded()) {
+                char* number = output.reserve(kMaxFormattedNumberLength);
+                char* numberEnd = formatNumber(number, record.value, numberFormat);
+                output.commit(static_cast<std::size_t>(numberEnd - number));
+            }
+
+            // Сообщения экранируются так же, как в CsvWriter: двойные кавычки заменяются одинарными
+            output.append(",\"");
+            if (record.errorCode != ErrorCatalog::kNoError) {
+                for (char ch : messages[record.errorCode - 1]) {
+                    output.append(ch == '"' ? '\'' : ch);
+                }
+            }
+            output.append("\"\n");
+            ++converted;
+        }
+    }
+
+    output.close();
+    return converted;
+}
+
+} // namespace expr
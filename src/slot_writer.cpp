@@ -0,0 +1,151 @@
+#include "slot_writer.hpp"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace expr {
+
+static_assert(std::endian::native == std::endian::little,
+    "Позиционный формат записывается в little-endian, другой порядок байт не поддерживается");
+static_assert(sizeof(EvaluationRecord) == kSlotSize, "Запись позиционного файла — это EvaluationRecord как есть");
+
+#ifdef _WIN32
+
+SlotWriter::SlotWriter(const std::filesystem::path&, const ErrorCatalog& errors, std::uint64_t)
+    : ResultWriter(errors) {
+    throw std::runtime_error("Позиционный формат не поддерживается на этой платформе");
+}
+
+SlotWriter::~SlotWriter() = default;
+bool SlotWriter::store(const EvaluationRecord&) { return false; }
+void SlotWriter::writeRecord(const EvaluationRecord&, std::string_view) {}
+void SlotWriter::flush() {}
+void SlotWriter::close() {}
+void SlotWriter::release() noexcept {}
+
+#else
+
+SlotWriter::SlotWriter(const std::filesystem::path& path, const ErrorCatalog& errors, std::uint64_t slotCount)
+    : ResultWriter(errors), slotCount(slotCount) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + path.string());
+    }
+
+    // Место под все записи выделяется сразу, чтобы запись через отображение
+    // не натыкалась на дыры в файле и не фрагментировала его
+    mappedSize = kSlotHeaderSize + static_cast<std::size_t>(slotCount) * kSlotSize;
+    int allocated = posix_fallocate(fd, 0, static_cast<off_t>(mappedSize));
+    if (allocated != 0 && ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+        release();
+        throw std::runtime_error("Не удалось выделить место под файл результатов: " + path.string());
+    }
+
+    void* address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        slots = nullptr;
+        release();
+        throw std::runtime_error("Не удалось отобразить файл результатов в память: " + path.string());
+    }
+    slots = static_cast<char*>(address);
+}
+
+SlotWriter::~SlotWriter() {
+    release();
+}
+
+bool SlotWriter::store(const EvaluationRecord& record) {
+    if (record.lineNumber == 0 || record.lineNumber > slotCount) {
+        return false;
+    }
+    std::memcpy(slots + kSlotHeaderSize + (record.lineNumber - 1) * kSlotSize, &record, kSlotSize);
+    recordCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SlotWriter::writeRecord(const EvaluationRecord& record, std::string_view /*expression*/) {
+    if (!store(record)) {
+        throw std::runtime_error("Номер строки " + std::to_string(record.lineNumber)
+            + " больше заранее подсчитанного числа строк");
+    }
+}
+
+void SlotWriter::flush() {
+    if (slots == nullptr) {
+        return;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (msync(slots, mappedSize, MS_SYNC) != 0) {
+        throw std::runtime_error("Ошибка записи в файл результатов");
+    }
+    writeStats.writeTime += std::chrono::steady_clock::now() - start;
+    ++writeStats.flushCount;
+}
+
+// Заголовок пишется в отображение, словарь — обычной записью в конец файла
+void SlotWriter::close() {
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    SlotFileHeader header{};
+    std::memcpy(header.magic, kSlotMagic, sizeof(kSlotMagic));
+    header.version = kSlotVersion;
+    header.slotSize = static_cast<std::uint32_t>(kSlotSize);
+    header.slotCount = slotCount;
+    header.dictionaryOffset = mappedSize;
+    std::memcpy(slots, &header, sizeof(header));
+
+    std::vector<char> dictionary;
+    auto put = [&dictionary](const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        dictionary.insert(dictionary.end(), bytes, bytes + size);
+    };
+    std::uint32_t messageCount = static_cast<std::uint32_t>(errors.size());
+    put(&messageCount, sizeof(messageCount));
+    for (std::uint32_t code = 1; code <= messageCount; ++code) {
+        std::string_view message = errors.message(code);
+        std::uint32_t length = static_cast<std::uint32_t>(message.size());
+        put(&length, sizeof(length));
+        put(message.data(), message.size());
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool failed = pwrite(fd, dictionary.data(), dictionary.size(), static_cast<off_t>(mappedSize))
+        != static_cast<ssize_t>(dictionary.size());
+    failed = msync(slots, mappedSize, MS_SYNC) != 0 || failed;
+    writeStats.writeTime += std::chrono::steady_clock::now() - start;
+    writeStats.bytesWritten = mappedSize + dictionary.size();
+    ++writeStats.flushCount;
+
+    release();
+    if (failed) {
+        throw std::runtime_error("Ошибка записи в файл результатов");
+    }
+}
+
+void SlotWriter::release() noexcept {
+    if (slots != nullptr) {
+        munmap(slots, mappedSize);
+        slots = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+#endif
+
+} // namespace expr
@@ -0,0 +1,160 @@
+#include "slow_line_tracker.hpp"
+
+#include "buffered_file.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+
+namespace expr {
+
+namespace {
+
+// Сравнение для min-кучи: самая быстрая строка наверху
+bool slowerThan(const SlowLine& left, const SlowLine& right) {
+    return left.cpuNanoseconds > right.cpuNanoseconds;
+}
+
+// Число узлов AST строки; строка, которая не разбирается, дает 0
+std::size_t countNodes(std::string_view text) {
+    try {
+        Tokenizer tokenizer(text);
+        Parser parser(tokenizer.tokenize());
+        return parser.parse()->nodeCount();
+    }
+    catch (const std::exception&) {
+        return 0;
+    }
+}
+
+template <class Integer>
+void appendInteger(BufferedFile& file, Integer value) {
+    char* out = file.reserve(24);
+    std::to_chars_result result = std::to_chars(out, out + 24, value);
+    file.commit(static_cast<std::size_t>(result.ptr - out));
+}
+
+// Микросекунды с тремя знаками: целая часть и остаток наносекунд
+void appendMicroseconds(BufferedFile& file, std::uint64_t nanoseconds) {
+    appendInteger(file, nanoseconds / 1000);
+    file.append('.');
+    char fraction[4] = {
+        static_cast<char>('0' + nanoseconds % 1000 / 100),
+        static_cast<char>('0' + nanoseconds % 100 / 10),
+        static_cast<char>('0' + nanoseconds % 10), 0 };
+    file.append(fraction);
+}
+
+// Поле CSV в кавычках, кавычки внутри удваиваются; обрезанный текст помечается "..."
+void appendQuoted(BufferedFile& file, std::string_view text, bool truncated) {
+    file.append('"');
+    for (char ch : text) {
+        if (ch == '"') {
+            file.append('"');
+        }
+        file.append(ch == '\r' ? ' ' : ch);
+    }
+    if (truncated) {
+        file.append("...");
+    }
+    file.append('"');
+}
+
+} // namespace
+
+SlowLineTracker::SlowLineTracker(std::size_t capacity) : capacity(capacity) {
+    heap.reserve(capacity);
+}
+
+void SlowLineTracker::offer(std::size_t lineNumber, std::uint64_t offset, std::string_view text,
+    std::uint64_t cpuNanoseconds, std::uint64_t wallNanoseconds, bool succeeded) {
+    if (capacity == 0) {
+        return;
+    }
+
+    // Разбор и копирование — до блокировки, чтобы другие потоки не ждали
+    SlowLine line;
+    line.lineNumber = lineNumber;
+    line.offset = offset;
+    line.length = static_cast<std::uint32_t>(text.size());
+    line.nodeCount = countNodes(text);
+    line.cpuNanoseconds = cpuNanoseconds;
+    line.wallNanoseconds = wallNanoseconds;
+    line.succeeded = succeeded;
+    line.preview = std::string(text.substr(0, kPreviewLength));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (heap.size() == capacity) {
+        // Пока разбирали, порог мог подняться
+        if (cpuNanoseconds <= heap.front().cpuNanoseconds) {
+            return;
+        }
+        std::pop_heap(heap.begin(), heap.end(), slowerThan);
+        heap.pop_back();
+    }
+    heap.push_back(std::move(line));
+    std::push_heap(heap.begin(), heap.end(), slowerThan);
+    if (heap.size() == capacity) {
+        threshold.store(heap.front().cpuNanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void SlowLineTracker::addLineOffset(std::uint64_t begin, std::uint64_t end, std::size_t linesBefore) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (SlowLine& line : heap) {
+        if (line.offset >= begin && line.offset < end) {
+            line.lineNumber += linesBefore;
+        }
+    }
+}
+
+std::vector<SlowLine> SlowLineTracker::slowest() const {
+    std::vector<SlowLine> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = heap;
+    }
+    std::sort(result.begin(), result.end(), slowerThan);
+    return result;
+}
+
+void SlowLineTracker::writeReport(const std::filesystem::path& path) const {
+    std::vector<SlowLine> lines = slowest();
+
+    BufferedFile file(path, 64 * 1024);
+    file.append("rank,line,length,nodes,cpu_us,wall_us,status,expression\n");
+    std::size_t rank = 0;
+    for (const SlowLine& line : lines) {
+        appendInteger(file, ++rank);
+        file.append(',');
+        appendInteger(file, line.lineNumber);
+        file.append(',');
+        appendInteger(file, line.length);
+        file.append(',');
+        appendInteger(file, line.nodeCount);
+        file.append(',');
+        appendMicroseconds(file, line.cpuNanoseconds);
+        file.append(',');
+        appendMicroseconds(file, line.wallNanoseconds);
+        file.append(line.succeeded ? ",success," : ",error,");
+        appendQuoted(file, line.preview, line.length > line.preview.size());
+        file.append('\n');
+    }
+    file.close();
+}
+
+std::uint64_t threadCpuNanoseconds() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec now{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+        return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + static_cast<std::uint64_t>(now.tv_nsec);
+    }
+#endif
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace expr
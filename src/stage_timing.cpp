@@ -0,0 +1,86 @@
+#include "stage_timing.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace expr {
+
+namespace {
+
+// Реестр гистограмм всех потоков. Поток регистрирует свои гистограммы при первом
+// замере, а при завершении переносит их в retired, чтобы не потерять измерения
+// потоков пула, уничтоженного до вывода статистики.
+struct StageRegistry {
+    std::mutex mutex;
+    std::vector<StageTimings*> live;
+    StageTimings retired;
+};
+
+StageRegistry& registry() {
+    static StageRegistry instance;
+    return instance;
+}
+
+// Гистограммы потока, зарегистрированные в реестре на время жизни потока
+struct ThreadStageSlot {
+    StageTimings timings;
+
+    ThreadStageSlot() {
+        StageRegistry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.live.push_back(&timings);
+    }
+
+    ~ThreadStageSlot() {
+        StageRegistry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.retired.merge(timings);
+        shared.live.erase(std::remove(shared.live.begin(), shared.live.end(), &timings), shared.live.end());
+    }
+};
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Tokenize: return "токенизация";
+    case Stage::Parse:    return "разбор";
+    case Stage::Evaluate: return "вычисление";
+    case Stage::Queue:    return "очередь пула";
+    case Stage::Write:    return "запись";
+    }
+    return "?";
+}
+
+void StageTimings::merge(const StageTimings& other) {
+    for (std::size_t i = 0; i < kStageCount; ++i) {
+        stages[i].merge(other.stages[i]);
+    }
+}
+
+StageTimings& threadStageTimings() {
+    thread_local ThreadStageSlot slot;
+    return slot.timings;
+}
+
+StageTimings collectStageTimings() {
+    StageRegistry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    StageTimings result = shared.retired;
+    for (const StageTimings* timings : shared.live) {
+        result.merge(*timings);
+    }
+    return result;
+}
+
+void resetStageTimings() {
+    StageRegistry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.retired = StageTimings{};
+    for (StageTimings* timings : shared.live) {
+        *timings = StageTimings{};
+    }
+}
+
+} // namespace expr
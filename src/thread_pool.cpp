@@ -31,6 +31,11 @@ ThreadPool::~ThreadPool() {
     }
 }
 
+std::size_t ThreadPool::queuedTasks() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+}
+
 // Логика работы отдельного потока
 void ThreadPool::workerLoop() {
     while (true) {
@@ -5,7 +5,7 @@
 
 namespace expr {
 
-Tokenizer::Tokenizer(std::string sourceText) : source(std::move(sourceText)) {}
+Tokenizer::Tokenizer(std::string_view sourceText) : source(sourceText) {}
 
 // Основной цикл разбора: проходит по строке и выделяет токены
 std::vector<Token> Tokenizer::tokenize() {
@@ -99,7 +99,7 @@ Token Tokenizer::makeNumber() {
         }
     }
 
-    std::string text = source.substr(start, index - start);
+    std::string text(source.substr(start, index - start));
     double value = std::stod(text);
     return {TokenType::Number, value, text, start};
 }
@@ -112,7 +112,7 @@ Token Tokenizer::makeIdentifier() {
         advance();
     }
 
-    std::string identifier = source.substr(start, index - start);
+    std::string identifier(source.substr(start, index - start));
     // Приведение к нижнему регистру
     for (char& ch : identifier) {
         ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
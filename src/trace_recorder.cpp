@@ -0,0 +1,203 @@
+#include "trace_recorder.hpp"
+
+#include "buffered_file.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace expr {
+
+namespace {
+
+// Одно событие: смещения от начала записи в наносекундах
+struct TraceEvent {
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::uint64_t count;
+};
+
+// Событий в одном блоке буфера: буфер растет блоками, без переноса старых событий
+constexpr std::size_t kEventsPerChunk = 4096;
+
+// Предел событий на поток, чтобы долгая запись не заняла всю память
+constexpr std::size_t kMaxEventsPerThread = 1 << 20;
+
+// Буфер событий одного потока. Пишет в него только владелец,
+// читают — только при сохранении, когда потоки простаивают.
+struct ThreadTraceBuffer {
+    std::uint32_t threadId = 0;
+    std::string name;
+    std::vector<std::unique_ptr<TraceEvent[]>> chunks;
+    std::size_t size = 0;
+    std::uint64_t dropped = 0; // Событий, не поместившихся в предел
+
+    void clear() {
+        chunks.clear();
+        size = 0;
+        dropped = 0;
+    }
+};
+
+// Буферы всех потоков, в том числе уже завершившихся: их события тоже нужны в файле
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+    std::uint32_t nextThreadId = 1;
+    std::chrono::steady_clock::time_point origin;
+};
+
+TraceRegistry& registry() {
+    static TraceRegistry instance;
+    return instance;
+}
+
+// Буфер текущего потока, регистрируется при первом обращении
+ThreadTraceBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadTraceBuffer> buffer = []() {
+        std::shared_ptr<ThreadTraceBuffer> created = std::make_shared<ThreadTraceBuffer>();
+        TraceRegistry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        created->threadId = shared.nextThreadId++;
+        created->name = "поток " + std::to_string(created->threadId);
+        shared.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+std::uint64_t sinceOrigin(std::chrono::steady_clock::time_point time) {
+    std::chrono::nanoseconds offset = time - registry().origin;
+    return offset.count() > 0 ? static_cast<std::uint64_t>(offset.count()) : 0;
+}
+
+// Микросекунды с тремя знаками после точки: формат времени Chrome Trace
+int formatMicroseconds(char* out, std::size_t size, std::uint64_t nanoseconds) {
+    return std::snprintf(out, size, "%llu.%03u",
+        static_cast<unsigned long long>(nanoseconds / 1000), static_cast<unsigned>(nanoseconds % 1000));
+}
+
+// Строка JSON в кавычках: кавычки, обратная косая черта и управляющие символы экранируются
+void appendJsonString(BufferedFile& file, std::string_view text) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    file.append('"');
+    for (char raw : text) {
+        unsigned char ch = static_cast<unsigned char>(raw);
+        if (ch == '"' || ch == '\\') {
+            file.append('\\');
+            file.append(raw);
+        }
+        else if (ch < 0x20) {
+            char escaped[7] = { '\\', 'u', '0', '0', kHexDigits[ch >> 4], kHexDigits[ch & 0x0F], 0 };
+            file.append(escaped);
+        }
+        else {
+            file.append(raw);
+        }
+    }
+    file.append('"');
+}
+
+} // namespace
+
+void startTracing() {
+    TraceRegistry& shared = registry();
+    {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        // Буферы завершившихся потоков больше не нужны, у живых — только очищаются
+        std::vector<std::shared_ptr<ThreadTraceBuffer>> live;
+        for (std::shared_ptr<ThreadTraceBuffer>& buffer : shared.buffers) {
+            if (buffer.use_count() > 1) {
+                buffer->clear();
+                live.push_back(std::move(buffer));
+            }
+        }
+        shared.buffers = std::move(live);
+        shared.origin = std::chrono::steady_clock::now();
+    }
+    trace_detail::active.store(true, std::memory_order_release);
+}
+
+void setTraceThreadName(std::string name) {
+    ThreadTraceBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = std::move(name);
+}
+
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end, std::uint64_t count) {
+    ThreadTraceBuffer& buffer = threadBuffer();
+    if (buffer.size >= kMaxEventsPerThread) {
+        ++buffer.dropped;
+        return;
+    }
+    if (buffer.size == buffer.chunks.size() * kEventsPerChunk) {
+        buffer.chunks.push_back(std::make_unique<TraceEvent[]>(kEventsPerChunk));
+    }
+    std::uint64_t startOffset = sinceOrigin(start);
+    std::uint64_t endOffset = sinceOrigin(end);
+    buffer.chunks[buffer.size / kEventsPerChunk][buffer.size % kEventsPerChunk] =
+        TraceEvent{ name, startOffset, endOffset - startOffset, count };
+    ++buffer.size;
+}
+
+std::size_t writeChromeTrace(const std::filesystem::path& path) {
+    trace_detail::active.store(false, std::memory_order_release);
+
+    TraceRegistry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+
+    BufferedFile file(path);
+    file.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::size_t written = 0;
+    constexpr std::size_t kMaxEventText = 256;
+    for (const std::shared_ptr<ThreadTraceBuffer>& buffer : shared.buffers) {
+        if (buffer->size == 0) {
+            continue;
+        }
+
+        // Имя потока — событие метаданных. Имя задается извне, поэтому экранируется
+        char* out = file.reserve(kMaxEventText);
+        int length = std::snprintf(out, kMaxEventText,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+            written > 0 ? ",\n" : "", buffer->threadId);
+        file.commit(static_cast<std::size_t>(length));
+        appendJsonString(file, buffer->name);
+        file.append("}}");
+        ++written;
+
+        for (std::size_t i = 0; i < buffer->size; ++i) {
+            const TraceEvent& event = buffer->chunks[i / kEventsPerChunk][i % kEventsPerChunk];
+            char start[32];
+            char duration[32];
+            formatMicroseconds(start, sizeof(start), event.start);
+            formatMicroseconds(duration, sizeof(duration), event.duration);
+
+            out = file.reserve(kMaxEventText);
+            length = std::snprintf(out, kMaxEventText,
+                ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%s,\"dur\":%s,\"args\":{\"n\":%llu}}",
+                event.name, buffer->threadId, start, duration, static_cast<unsigned long long>(event.count));
+            file.commit(static_cast<std::size_t>(length));
+            ++written;
+        }
+
+        // Переполнение буфера видно прямо в трассировке
+        if (buffer->dropped > 0) {
+            out = file.reserve(kMaxEventText);
+            length = std::snprintf(out, kMaxEventText,
+                ",\n{\"name\":\"события отброшены\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":0,\"args\":{\"n\":%llu}}",
+                buffer->threadId, static_cast<unsigned long long>(buffer->dropped));
+            file.commit(static_cast<std::size_t>(length));
+        }
+    }
+
+    file.append("\n]}\n");
+    file.close();
+    return written;
+}
+
+} // namespace expr
@@ -6,6 +6,7 @@
 #include <cctype>
 #include <filesystem>
 #include <iostream>
+#include <random>
 #include <string>
 #include <thread>
 
@@ -168,6 +169,198 @@ std::size_t selectThreadCount() {
     return parseNumber(input);
 }
 
+// Интерактивный выбор дополнительных настроек обработки
+// Пустой ответ на вопрос о расширенных настройках оставляет значения по умолчанию
+ProcessingOptions selectProcessingOptions() {
+    ProcessingOptions options;
+
+    std::cout << Color::BOLD << "Расширенные настройки? (y/n, по умолчанию n): " << Color::RESET;
+    std::string input;
+    std::getline(std::cin, input);
+
+    // Удаление пробелов и приведение к нижнему регистру
+    input.erase(0, input.find_first_not_of(" \t"));
+    input.erase(input.find_last_not_of(" \t") + 1);
+    std::transform(input.begin(), input.end(), input.begin(), ::tolower);
+
+    if (!(input == "y" || input == "yes" || input == "д" || input == "да")) {
+        return options;
+    }
+
+    std::cout << Color::BOLD << "Режим чтения файла:\n" << Color::RESET;
+    std::cout << "  " << Color::CYAN << "1" << Color::RESET << ". Последовательный (один поток читает строки)\n";
+    std::cout << "  " << Color::CYAN << "2" << Color::RESET << ". Параллельный по диапазонам байт\n";
+    std::cout << Color::BOLD << "Ваш выбор (по умолчанию 1): " << Color::RESET;
+
+    std::string choice;
+    std::getline(std::cin, choice);
+
+    // Удаление пробелов
+    choice.erase(0, choice.find_first_not_of(" \t"));
+    choice.erase(choice.find_last_not_of(" \t") + 1);
+
+    if (choice == "2") {
+        options.readMode = ReadMode::ByteRanges;
+    }
+    else if (!choice.empty() && choice != "1") {
+        throw std::runtime_error("Некорректный выбор. Используйте 1 или 2");
+    }
+
+    // Точный подсчет строк нужен только для прогресса в строках и стоит лишнего прохода по файлу
+    std::cout << Color::BOLD << "Заранее подсчитать количество строк? (y/n, по умолчанию n): " << Color::RESET;
+    std::string countAnswer;
+    std::getline(std::cin, countAnswer);
+
+    // Удаление пробелов и приведение к нижнему регистру
+    countAnswer.erase(0, countAnswer.find_first_not_of(" \t"));
+    countAnswer.erase(countAnswer.find_last_not_of(" \t") + 1);
+    std::transform(countAnswer.begin(), countAnswer.end(), countAnswer.begin(), ::tolower);
+    options.exactLineCount = (countAnswer == "y" || countAnswer == "yes" || countAnswer == "д" || countAnswer == "да");
+
+    std::cout << Color::BOLD << "Формат чисел в результатах:\n" << Color::RESET;
+    std::cout << "  " << Color::CYAN << "1" << Color::RESET << ". Фиксированная точка, 10 знаков (совместимый)\n";
+    std::cout << "  " << Color::CYAN << "2" << Color::RESET << ". Кратчайшее точное представление\n";
+    std::cout << Color::BOLD << "Ваш выбор (по умолчанию 1): " << Color::RESET;
+
+    std::string formatChoice;
+    std::getline(std::cin, formatChoice);
+
+    // Удаление пробелов
+    formatChoice.erase(0, formatChoice.find_first_not_of(" \t"));
+    formatChoice.erase(formatChoice.find_last_not_of(" \t") + 1);
+
+    if (formatChoice == "2") {
+        options.numberFormat = expr::NumberFormat::Shortest;
+    }
+    else if (!formatChoice.empty() && formatChoice != "1") {
+        throw std::runtime_error("Некорректный выбор. Используйте 1 или 2");
+    }
+
+    std::cout << Color::BOLD << "Формат файла результатов:\n" << Color::RESET;
+    std::cout << "  " << Color::CYAN << "1" << Color::RESET << ". CSV\n";
+    std::cout << "  " << Color::CYAN << "2" << Color::RESET << ". Бинарный колоночный (.col)\n";
+    std::cout << "  " << Color::CYAN << "3" << Color::RESET << ". NDJSON, JSON-объект на строку (.ndjson)\n";
+    std::cout << "  " << Color::CYAN << "4" << Color::RESET << ". Позиционный бинарный, 32 байта на строку (.slots)\n";
+    std::cout << Color::BOLD << "Ваш выбор (по умолчанию 1): " << Color::RESET;
+
+    std::string outputChoice;
+    std::getline(std::cin, outputChoice);
+
+    // Удаление пробелов
+    outputChoice.erase(0, outputChoice.find_first_not_of(" \t"));
+    outputChoice.erase(outputChoice.find_last_not_of(" \t") + 1);
+
+    if (outputChoice == "2") {
+        options.outputFormat = expr::OutputFormat::Columnar;
+    }
+    else if (outputChoice == "3") {
+        options.outputFormat = expr::OutputFormat::Ndjson;
+    }
+    else if (outputChoice == "4") {
+        options.outputFormat = expr::OutputFormat::Slots;
+    }
+    else if (!outputChoice.empty() && outputChoice != "1") {
+        throw std::runtime_error("Некорректный выбор. Используйте 1, 2, 3 или 4");
+    }
+
+    std::cout << Color::BOLD << "Профиль вывода:\n" << Color::RESET;
+    std::cout << "  " << Color::CYAN << "1" << Color::RESET << ". Полный (с текстом выражения)\n";
+    std::cout << "  " << Color::CYAN << "2" << Color::RESET << ". Сжатый (строка, статус, результат, код ошибки)\n";
+    std::cout << "  " << Color::CYAN << "3" << Color::RESET << ". Только ошибки\n";
+    std::cout << Color::BOLD << "Ваш выбор (по умолчанию 1): " << Color::RESET;
+
+    std::string profileChoice;
+    std::getline(std::cin, profileChoice);
+
+    // Удаление пробелов
+    profileChoice.erase(0, profileChoice.find_first_not_of(" \t"));
+    profileChoice.erase(profileChoice.find_last_not_of(" \t") + 1);
+
+    if (profileChoice == "2") {
+        options.outputProfile = expr::OutputProfile::Lean;
+    }
+    else if (profileChoice == "3") {
+        options.outputProfile = expr::OutputProfile::ErrorsOnly;
+    }
+    else if (!profileChoice.empty() && profileChoice != "1") {
+        throw std::runtime_error("Некорректный выбор. Используйте 1, 2 или 3");
+    }
+
+    std::cout << Color::BOLD << "Буферов фоновой записи" << Color::RESET
+        << " (0 — без фонового потока, по умолчанию: " << Color::CYAN << options.writeBuffers << Color::RESET << "): ";
+    std::string buffersInput;
+    std::getline(std::cin, buffersInput);
+
+    // Удаление пробелов
+    buffersInput.erase(0, buffersInput.find_first_not_of(" \t"));
+    buffersInput.erase(buffersInput.find_last_not_of(" \t") + 1);
+
+    if (buffersInput == "0") {
+        options.writeBuffers = 0;
+    }
+    else if (!buffersInput.empty()) {
+        options.writeBuffers = parseNumber(buffersInput);
+    }
+
+    // Трассировка для chrome://tracing или ui.perfetto.dev: интервалы работы каждого потока
+    std::cout << Color::BOLD << "Файл трассировки Chrome" << Color::RESET << " (Enter — не записывать): ";
+    std::string traceInput;
+    std::getline(std::cin, traceInput);
+
+    // Удаление пробелов
+    traceInput.erase(0, traceInput.find_first_not_of(" \t"));
+    traceInput.erase(traceInput.find_last_not_of(" \t") + 1);
+
+    if (!traceInput.empty()) {
+        options.tracePath = traceInput;
+    }
+
+    // Отчет о самых медленных строках пишется рядом с результатами: <имя>_slowest.csv
+    std::cout << Color::BOLD << "Отчет о самых медленных строках" << Color::RESET
+        << " (сколько строк, 0 — без отчета, по умолчанию: " << Color::CYAN << options.slowLineCount << Color::RESET << "): ";
+    std::string slowInput;
+    std::getline(std::cin, slowInput);
+
+    // Удаление пробелов
+    slowInput.erase(0, slowInput.find_first_not_of(" \t"));
+    slowInput.erase(slowInput.find_last_not_of(" \t") + 1);
+
+    if (slowInput == "0") {
+        options.slowLineCount = 0;
+    }
+    else if (!slowInput.empty()) {
+        options.slowLineCount = parseNumber(slowInput);
+    }
+
+    // Показатели для textfile collector из node_exporter, обновляются во время обработки
+    std::cout << Color::BOLD << "Файл метрик Prometheus" << Color::RESET << " (Enter — не записывать): ";
+    std::string metricsInput;
+    std::getline(std::cin, metricsInput);
+
+    // Удаление пробелов
+    metricsInput.erase(0, metricsInput.find_first_not_of(" \t"));
+    metricsInput.erase(metricsInput.find_last_not_of(" \t") + 1);
+
+    if (!metricsInput.empty()) {
+        options.metricsPath = metricsInput;
+
+        std::cout << Color::BOLD << "Интервал обновления метрик" << Color::RESET
+            << " (секунд, по умолчанию: " << Color::CYAN << options.metricsInterval.count() << Color::RESET << "): ";
+        std::string intervalInput;
+        std::getline(std::cin, intervalInput);
+
+        // Удаление пробелов
+        intervalInput.erase(0, intervalInput.find_first_not_of(" \t"));
+        intervalInput.erase(intervalInput.find_last_not_of(" \t") + 1);
+
+        if (!intervalInput.empty()) {
+            options.metricsInterval = std::chrono::seconds(parseNumber(intervalInput));
+        }
+    }
+
+    return options;
+}
+
 // Запрос продолжения работы с другим файлом
 bool askContinue() {
     std::cout << Color::BOLD << "Обработать еще один файл? (y/n): " << Color::RESET;
@@ -199,6 +392,120 @@ std::size_t askExpressionCount() {
     return parseNumber(input);
 }
 
+// Интерактивный ввод зерна генератора.
+// Одно и то же зерно дает один и тот же файл при любом числе потоков.
+std::uint64_t askGeneratorSeed() {
+    std::cout << Color::BOLD << "Зерно генератора" << Color::RESET << " (по умолчанию случайное): ";
+    std::string input;
+    std::getline(std::cin, input);
+
+    // Удаление пробелов
+    input.erase(0, input.find_first_not_of(" \t"));
+    input.erase(input.find_last_not_of(" \t") + 1);
+
+    if (input.empty()) {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }
+
+    try {
+        std::size_t parsed = 0;
+        std::uint64_t seed = std::stoull(input, &parsed);
+        if (parsed != input.size()) {
+            throw std::invalid_argument(input);
+        }
+        return seed;
+    }
+    catch (const std::exception&) {
+        throw std::runtime_error("Некорректное зерно: ожидается целое неотрицательное число");
+    }
+}
+
+// Интерактивный выбор профиля нагрузки генератора
+GeneratorProfile selectGeneratorProfile() {
+    std::cout << Color::BOLD << "Профиль нагрузки:\n" << Color::RESET;
+    for (std::string_view name : generatorProfileNames()) {
+        std::cout << "  " << Color::CYAN << name << Color::RESET << "\n";
+    }
+    std::cout << Color::BOLD << "Имя профиля или путь к файлу параметров (по умолчанию default): " << Color::RESET;
+
+    std::string input;
+    std::getline(std::cin, input);
+
+    // Удаление пробелов
+    input.erase(0, input.find_first_not_of(" \t"));
+    input.erase(input.find_last_not_of(" \t") + 1);
+
+    if (input.empty()) {
+        return namedGeneratorProfile("default");
+    }
+    const std::vector<std::string_view>& names = generatorProfileNames();
+    if (std::find(names.begin(), names.end(), input) != names.end()) {
+        return namedGeneratorProfile(input);
+    }
+    if (std::filesystem::exists(input)) {
+        return loadGeneratorProfile(input);
+    }
+    throw std::runtime_error("Неизвестный профиль и файл параметров не найден: " + input);
+}
+
+// Интерактивный выбор ограничения нагрузочного теста
+LoadTestLimit askLoadTestLimit() {
+    LoadTestLimit limit;
+
+    std::cout << Color::BOLD << "Ограничение теста:\n" << Color::RESET;
+    std::cout << "  " << Color::CYAN << "1" << Color::RESET << ". По времени\n";
+    std::cout << "  " << Color::CYAN << "2" << Color::RESET << ". По количеству выражений\n";
+    std::cout << Color::BOLD << "Ваш выбор (по умолчанию 1): " << Color::RESET;
+
+    std::string choice;
+    std::getline(std::cin, choice);
+
+    // Удаление пробелов
+    choice.erase(0, choice.find_first_not_of(" \t"));
+    choice.erase(choice.find_last_not_of(" \t") + 1);
+
+    if (choice == "2") {
+        limit.expressionCount = askExpressionCount();
+        return limit;
+    }
+    if (!choice.empty() && choice != "1") {
+        throw std::runtime_error("Некорректный выбор. Используйте 1 или 2");
+    }
+
+    std::cout << Color::BOLD << "Длительность в секундах" << Color::RESET
+        << " (по умолчанию: " << Color::CYAN << limit.seconds << Color::RESET << "): ";
+    std::string input;
+    std::getline(std::cin, input);
+
+    // Удаление пробелов
+    input.erase(0, input.find_first_not_of(" \t"));
+    input.erase(input.find_last_not_of(" \t") + 1);
+
+    if (!input.empty()) {
+        limit.seconds = static_cast<double>(parseNumber(input));
+    }
+    return limit;
+}
+
+// Интерактивный ввод количества потоков генерации
+std::size_t askProducerCount() {
+    std::cout << Color::BOLD << "Введите количество потоков генерации" << Color::RESET
+        << " (по умолчанию: " << Color::CYAN << 1 << Color::RESET << "): ";
+
+    std::string input;
+    std::getline(std::cin, input);
+
+    // Удаление пробелов
+    input.erase(0, input.find_first_not_of(" \t"));
+    input.erase(input.find_last_not_of(" \t") + 1);
+
+    if (input.empty()) {
+        return 1;
+    }
+    return parseNumber(input);
+}
+
 // Интерактивный выбор имени файла для генерации
 std::filesystem::path selectGeneratedFileName(std::size_t expressionCount) {
     std::cout << Color::BOLD << "Выберите способ задания имени файла:\n" << Color::RESET;
@@ -0,0 +1,17 @@
+# Регрессия: ошибка записи в середине обработки должна давать код завершения 2,
+# а не падение или зависание (задачи пула не должны пережить окно и счетчики).
+# Запуск: cmake -DPARSER=<программа> -DTHREADS=<N> -DWORK_DIR=<каталог> -P full_disk_exit_code.cmake
+string(REPEAT "(1.5 + 2) * sin(0.3) - 4 / 7\n" 300000 lines)
+set(input "${WORK_DIR}/full_disk_input_${THREADS}.txt")
+file(WRITE "${input}" "${lines}")
+
+execute_process(
+    COMMAND "${PARSER}" -q -t ${THREADS} -i "${input}" -o /dev/full
+    RESULT_VARIABLE exitCode
+    ERROR_VARIABLE errorOutput
+    TIMEOUT 60)
+file(REMOVE "${input}")
+
+if(NOT exitCode EQUAL 2)
+    message(FATAL_ERROR "Ожидался код завершения 2 при записи в /dev/full, получено: ${exitCode}\n${errorOutput}")
+endif()